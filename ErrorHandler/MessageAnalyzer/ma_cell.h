@@ -48,7 +48,7 @@ public:
 	get_latest_message() const
 	{
 		assert(!msgs.empty());
-		return msgs.back().text(false).toStdString();
+		return std::string(msgs.back().body());
 	}
 
 	// get group
@@ -154,7 +154,7 @@ void ma_condition::extract_fields(qt_mf_msg const& msg)
 	sev_ = msg.sev();
 	get_source_from_msg(src_, msg);
 	cat_ = msg.cat().toStdString();
-	bdy_ = msg.text(false).toStdString();
+	bdy_ = msg.body();
 }
 
 void ma_condition::update_fields()
@@ -73,8 +73,7 @@ MsgAnalyzerDlg::MsgAnalyzerDlg(std::string const &cfgfile, int partition, QDialo
 	connect(btnReset, SIGNAL(clicked()), this, SLOT(reset()));
 	connect(btnExit, SIGNAL(clicked()), this, SLOT(exit()));
 
-	connect(&receiver, SIGNAL(newMessage(qt_mf_msg const &)), this, SLOT(onNewMsg(qt_mf_msg const &)));
-	connect(&receiver, SIGNAL(newMessage(qt_mf_msg const &)), &engine, SLOT(feed(qt_mf_msg const &)));
+	connect(&receiver, SIGNAL(newMessages(msg_batch_t const &)), this, SLOT(onNewMsgs(msg_batch_t const &)));
 
 	connect(lwMain, SIGNAL(itemDoubleClicked(QListWidgetItem *)), this, SLOT(onNodeClicked(QListWidgetItem *)));
 	connect(lwDCM, SIGNAL(itemDoubleClicked(QListWidgetItem *)), this, SLOT(onNodeClicked(QListWidgetItem *)));
@@ -219,6 +218,16 @@ bool MsgAnalyzerDlg::check_node_aoe(std::string const &key)
 	return false;
 }
 
+void MsgAnalyzerDlg::onNewMsgs(msg_batch_t const &msgs)
+{
+	// The receivers deliver messages in batches; each goes to the node status panel, then to the rule engine
+	for (auto const &msg : msgs)
+	{
+		onNewMsg(*msg);
+		engine.feed(*msg);
+	}
+}
+
 void MsgAnalyzerDlg::onNewMsg(qt_mf_msg const &mfmsg)
 {
 	// basic message filtering according to the host and app
@@ -6,7 +6,7 @@
 #include "ErrorHandler/Components/NodeInfo.h"
 #include "ErrorHandler/Components/qt_rule_engine.h"
 #include "ErrorHandler/MessageAnalyzer/ma_utils.h"
-#include "mfextensions/Receivers/ReceiverManager.hh"
+#include "mfextensions/Receivers/QtReceiverAdaptor.hh"
 
 #include <QtCore/QMutex>
 #include <QtCore/QSignalMapper>
@@ -47,7 +47,7 @@ protected:
 
 private slots:
 
-	void onNewMsg(qt_mf_msg const &mfmsg);
+	void onNewMsgs(msg_batch_t const &msgs);
 	void onNewSysMsg(sev_code_t, QString const &msg);
 
 	void onNewAlarm(QString const &rule_name, QString const &msg);
@@ -87,6 +87,9 @@ private slots:
 	void onSetParticipants(QVector<QString> const &dcm, QVector<QString> const &bnevb);
 
 private:
+	// Update the node status panel with a received message
+	void onNewMsg(qt_mf_msg const &mfmsg);
+
 	void reset_node_status();
 	void reset_rule_engine();
 
@@ -106,7 +109,7 @@ private:
 	// data member
 	fhicl::ParameterSet pset;
 	qt_rule_engine engine;
-	mfviewer::ReceiverManager receiver;
+	mfviewer::QtReceiverAdaptor receiver;
 
 	map_t map;
 	int nmsgs;
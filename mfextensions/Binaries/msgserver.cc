@@ -3,15 +3,16 @@
 
 #include <boost/program_options.hpp>
 
+#include <atomic>
 #include <iostream>
 #include <string>
+#include <thread>
 #include "fhiclcpp/ParameterSet.h"
 #include "mfextensions/Receivers/ReceiverManager.hh"
 
 namespace po = boost::program_options;
 
 bool cmdline = false;
-int z = 0;
 
 int main(int argc, char* argv[])
 {
@@ -62,6 +63,17 @@ int main(int argc, char* argv[])
 	auto maker = cet::filepath_maker();
 	fhicl::ParameterSet pset = fhicl::ParameterSet::make(configFile, maker);
 	mfviewer::ReceiverManager rm(pset);
+	rm.start();
+
+	// Messages are only counted, but the receivers' queues must still be emptied
+	std::atomic<bool> running{true};
+	std::thread consumer([&rm, &running] {
+		while (running)
+		{
+			rm.waitForMessages(std::chrono::milliseconds(100));
+			rm.drain([](mf_msg_batch_t& /*batch*/) {});
+		}
+	});
 
 	// Welcome message
 	std::cout << "Message Facility MsgServer is up and listening to configured Receivers" << std::endl;
@@ -89,7 +101,7 @@ int main(int argc, char* argv[])
 		else if (cmdline && (cmd == "q" || cmd == "quit"))
 		{
 			// dds.stop();
-			return 0;
+			break;
 		}
 		else if (cmdline && (cmd == "h" || cmd == "help"))
 		{
@@ -103,7 +115,12 @@ int main(int argc, char* argv[])
 		}
 		else if (cmdline && (cmd == "s" || cmd == "stat"))
 		{
-			std::cout << "Currently listening, " << z << " messages have been received." << std::endl;
+			auto stats = rm.statistics();
+			std::cout << "Currently listening, " << stats["messages"] << " messages have been received." << std::endl;
+			for (auto const& counter : stats)
+			{
+				std::cout << "  " << counter.first << ": " << counter.second << std::endl;
+			}
 		}
 		else if (cmdline)
 		{
@@ -112,5 +129,7 @@ int main(int argc, char* argv[])
 		}
 	}  // end of command line message loop
 
+	running = false;
+	consumer.join();
 	return 0;
 }
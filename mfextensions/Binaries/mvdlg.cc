@@ -1,6 +1,6 @@
+#include <QAction>
 #include <QMenu>
 #include <QMessageBox>
-#include <QProgressDialog>
 #include <QScrollBar>
 #include <QtGui>
 
@@ -81,7 +81,7 @@ static fhicl::ParameterSet readConf(std::string const& fname)
 }
 
 msgViewerDlg::msgViewerDlg(std::string const& conf, QDialog* parent)
-    : QDialog(parent), paused(false), shortMode_(false), nMsgs(0), nSupMsgs(0), nThrMsgs(0), nFilters(0), nDeleted(0), simpleRender(true), searchStr(""), msg_pool_(), host_msgs_(), cat_msgs_(), app_msgs_(), sup_menu(new QMenu(this)), thr_menu(new QMenu(this)), receivers_(readConf(conf).get<fhicl::ParameterSet>("receivers", fhicl::ParameterSet()))
+    : QDialog(parent), paused(false), shortMode_(false), nMsgs(0), nSupMsgs(0), nThrMsgs(0), nFilters(0), nDeleted(0), simpleRender(true), delegate_(new msgItemDelegate(this)), searchStr(""), searchPosition_(0), msg_pool_(), host_msgs_(), cat_msgs_(), app_msgs_(), sup_menu(new QMenu(this)), thr_menu(new QMenu(this)), receivers_(readConf(conf).get<fhicl::ParameterSet>("receivers", fhicl::ParameterSet()))
 {
 	setupUi(this);
 
@@ -123,12 +123,17 @@ msgViewerDlg::msgViewerDlg(std::string const& conf, QDialog* parent)
 
 	connect(vsSeverity, SIGNAL(valueChanged(int)), this, SLOT(changeSeverity(int)));
 
-	connect(&receivers_, SIGNAL(newMessage(msg_ptr_t)), this, SLOT(onNewMsg(msg_ptr_t)));
+	connect(&receivers_, SIGNAL(newMessages(msg_batch_t)), this, SLOT(onNewMsgs(msg_batch_t)));
+
+	uiTimer_.setSingleShot(true);
+	connect(&uiTimer_, SIGNAL(timeout()), this, SLOT(flushUpdates()));
 
 	connect(tabWidget, SIGNAL(currentChanged(int)), this, SLOT(tabWidgetCurrentChanged(int)));
 	connect(tabWidget, SIGNAL(tabCloseRequested(int)), this, SLOT(tabCloseRequested(int)));
 	MsgFilterDisplay allMessages;
-	allMessages.txtDisplay = txtMessages;
+	allMessages.view = lvMessages;
+	allMessages.model = new msgListModel(this);
+	setup_view(lvMessages, allMessages.model);
 	allMessages.nDisplayMsgs = 0;
 	allMessages.filterExpression = "";
 	allMessages.nDisplayedDeletedMsgs = 0;
@@ -149,9 +154,6 @@ msgViewerDlg::msgViewerDlg(std::string const& conf, QDialog* parent)
 
 	changeSeverity(SINFO);
 
-	auto doc = new QTextDocument(txtMessages);
-	txtMessages->setDocument(doc);
-
 	receivers_.start();
 }
 
@@ -246,7 +248,12 @@ void msgViewerDlg::parseConf(fhicl::ParameterSet const& conf)
 	pset_to_throttle(thr_cat, e_thr_cat, thr_menu);
 
 	maxMsgs = conf.get<size_t>("max_message_buffer_size", 100000);
+	msg_pool_.reserve(maxMsgs);  // trimmed once per batch, so it may still grow by a batch
+	qt_mf_msg::reserve(maxMsgs);
 	maxDeletedMsgs = conf.get<size_t>("max_displayed_deleted_messages", 100000);
+
+	auto uiRate = conf.get<double>("ui_update_rate", 20);
+	uiTimer_.setInterval(uiRate > 0 ? static_cast<int>(1000 / uiRate) : 0);
 }
 
 bool msgViewerDlg::msg_throttled(msg_ptr_t const& msg)
@@ -256,13 +263,13 @@ bool msgViewerDlg::msg_throttled(msg_ptr_t const& msg)
 	++nSupMsgs;
 
 	for (size_t i = 0; i < e_sup_host.size(); ++i)
-		if (e_sup_host[i].match(msg->host().toStdString())) return true;
+		if (e_sup_host[i].match(msg->hostname())) return true;
 
 	for (size_t i = 0; i < e_sup_app.size(); ++i)
 		if (e_sup_app[i].match(msg->app().toStdString())) return true;
 
 	for (size_t i = 0; i < e_sup_cat.size(); ++i)
-		if (e_sup_cat[i].match(msg->cat().toStdString())) return true;
+		if (e_sup_cat[i].match(msg->category())) return true;
 
 	--nSupMsgs;
 
@@ -271,13 +278,13 @@ bool msgViewerDlg::msg_throttled(msg_ptr_t const& msg)
 	++nThrMsgs;
 
 	for (size_t i = 0; i < e_thr_host.size(); ++i)
-		if (e_thr_host[i].reach_limit(msg->host().toStdString(), msg->time())) return true;
+		if (e_thr_host[i].reach_limit(msg->hostname(), msg->time())) return true;
 
 	for (size_t i = 0; i < e_thr_app.size(); ++i)
 		if (e_thr_app[i].reach_limit(msg->app().toStdString(), msg->time())) return true;
 
 	for (size_t i = 0; i < e_thr_cat.size(); ++i)
-		if (e_thr_cat[i].reach_limit(msg->cat().toStdString(), msg->time())) return true;
+		if (e_thr_cat[i].reach_limit(msg->category(), msg->time())) return true;
 
 	--nThrMsgs;
 
@@ -306,262 +313,276 @@ void msgViewerDlg::readSettings()
 	settings.endGroup();
 }
 
-void msgViewerDlg::onNewMsg(msg_ptr_t const& msg)
+void msgViewerDlg::onNewMsgs(msg_batch_t const& msgs)
 {
 	// 21-Aug-2015, KAB: copying the incrementing (and displaying) of the number
 	// of messages to here. I'm also not sure if we want to
 	// count all messages or just non-suppressed ones or what. But, at least this
 	// change gets the counter incrementing on the display.
-	++nMsgs;
+	nMsgs += static_cast<int>(msgs.size());
+
+	for (auto const& msg : msgs)
+	{
+		add_msg(msg);
+	}
+
+	// Trim once for the whole batch, rather than once per message
+	trim_msg_pool();
+
+	update_shed_count();
+
+	// The widgets show the changes at the next frame, together with those of any batches arriving before it
+	if (!uiTimer_.isActive()) uiTimer_.start();
+}
+
+void msgViewerDlg::flushUpdates()
+{
+	{
+		std::lock_guard<std::mutex> lk(msg_classification_mutex_);
+		updateList(lwHost, host_changes_);
+		updateList(lwApplication, app_changes_);
+		updateList(lwCategory, cat_changes_);
+	}
+
+	for (size_t d = 0; d < msgFilters_.size(); ++d)
+	{
+		auto& display = msgFilters_[d];
+		bool current = (int)d == tabWidget->currentIndex();
+		if (!display.pendingRows.empty())
+		{
+			bool is_scrolled_down =
+			    display.view->verticalScrollBar()->value() >= display.view->verticalScrollBar()->maximum() * 0.95;  // At least 95% scrolled down
+
+			// The user has scrolled away from the bottom: keep the position
+			if (current && !paused && !is_scrolled_down)
+			{
+				pause();
+			}
+
+			display.model->append(display.pendingRows);
+			display.pendingRows.clear();
+			if (current && !paused) display.view->scrollToBottom();
+		}
+
+		// The deleted messages still shown are the oldest rows
+		if (maxDeletedMsgs > 0 && display.nDisplayedDeletedMsgs > static_cast<int>(maxDeletedMsgs))
+		{
+			display.model->dropFront(display.nDisplayedDeletedMsgs);
+			display.nDisplayMsgs -= display.nDisplayedDeletedMsgs;
+			display.nDisplayedDeletedMsgs = 0;
+		}
+
+		if (current)
+		{
+			lcdDisplayedMsgs->display(display.nDisplayMsgs);
+			lcdDisplayedDeleted->display(display.nDisplayedDeletedMsgs);
+		}
+	}
+
 	lcdMsgs->display(nMsgs);
+	lcdSuppressionCount->display(nSupMsgs);
+	lcdThrottlingCount->display(nThrMsgs);
+	lcdDeletedCount->display(nDeleted);
+}
 
-	// test if the message is suppressed or throttled
-	if (msg_throttled(msg))
+void msgViewerDlg::update_shed_count()
+{
+	auto now = std::chrono::steady_clock::now();
+	if (now - lastShedCheck_ < std::chrono::seconds(1)) return;
+	lastShedCheck_ = now;
+
+	auto stats = receivers_.statistics();
+	if (stats["messages_shed"] == nShed) return;
+	nShed = stats["messages_shed"];
+	lcdShedCount->display(static_cast<int>(nShed));
+
+	// Summary of what was shed, per severity and per category
+	QString summary = QString("Messages dropped by the receivers because the viewer fell behind:\n"
+	                          "DEBUG: %1, INFO: %2, WARNING: %3")
+	                      .arg(stats["messages_shed_debug"])
+	                      .arg(stats["messages_shed_info"])
+	                      .arg(stats["messages_shed_warning"]);
+	std::string const prefix = "messages_shed_category:";
+	for (auto it = stats.lower_bound(prefix); it != stats.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
 	{
-		lcdSuppressionCount->display(nSupMsgs);
-		lcdThrottlingCount->display(nThrMsgs);
-		return;
+		summary += QString("\n%1: %2").arg(QString::fromStdString(it->first.substr(prefix.size()))).arg(it->second);
 	}
+	lcdShedCount->setToolTip(summary);
+}
+
+void msgViewerDlg::add_msg(msg_ptr_t const& msg)
+{
+	// test if the message is suppressed or throttled
+	if (msg_throttled(msg)) return;
 
 	// push the message to the message pool
+	msg_position_t position;
 	{
 		// std::lock_guard<std::mutex> lk(msg_pool_mutex_);
-		msg_pool_.emplace_back(msg);
+		position = msg_pool_.push_back(msg);
 	}
-	trim_msg_pool();
 
 	// update corresponding lists of index
-	update_index(msg);
+	update_index(msg, position);
 
-	// Update filtered displays
+	// Update filtered displays. Tabs sharing a body pattern share the result of matching it.
+	std::vector<std::pair<mfviewer::detail::BodyPattern const*, bool>> bodyMatches;
+	auto body_match = [&](std::shared_ptr<mfviewer::detail::BodyPattern const> const& pattern) {
+		if (!pattern) return true;
+		for (auto const& match : bodyMatches)
+		{
+			if (match.first == pattern.get()) return match.second;
+		}
+		bodyMatches.emplace_back(pattern.get(), pattern->matches(msg->body()));
+		return bodyMatches.back().second;
+	};
 	for (size_t d = 0; d < msgFilters_.size(); ++d)
 	{
-		bool hostMatch =
-		    msgFilters_[d].hostFilter.contains(msg->host(), Qt::CaseInsensitive) || msgFilters_[d].hostFilter.empty();
-		bool appMatch =
-		    msgFilters_[d].appFilter.contains(msg->app(), Qt::CaseInsensitive) || msgFilters_[d].appFilter.empty();
-		bool catMatch =
-		    msgFilters_[d].catFilter.contains(msg->cat(), Qt::CaseInsensitive) || msgFilters_[d].catFilter.empty();
+		bool hostMatch = filter_match(msgFilters_[d].hostIds, msg->hostId());
+		bool appMatch = filter_match(msgFilters_[d].appIds, msg->appId());
+		bool catMatch = filter_match(msgFilters_[d].catIds, msg->catId());
 
 		// Check to display the message
-		if (hostMatch && appMatch && catMatch)
+		if (hostMatch && appMatch && catMatch && body_match(msgFilters_[d].bodyPattern))
 		{
 			{
 				// std::lock_guard<std::mutex> lk(filter_mutex_);
 				msgFilters_[d].msgs.push_back(msg);
 			}
-			if ((int)d == tabWidget->currentIndex())
-				displayMsg(msg, d);
+			displayMsg(msg, d);
 		}
 	}
 }
 
 void msgViewerDlg::trim_msg_pool()
 {
-	bool host_list_update = false;
-	bool app_list_update = false;
-	bool cat_list_update = false;
 	{
 		std::lock_guard<std::mutex> lk(msg_pool_mutex_);
 		while (maxMsgs > 0 && msg_pool_.size() > maxMsgs)
 		{
-			QString const& app = msg_pool_.front()->app();
-			QString const& cat = msg_pool_.front()->cat();
-			QString const& host = msg_pool_.front()->host();
-
-			// Check if we can remove an app/host/category
-			{
-				auto catIter = std::find(cat_msgs_[cat].begin(), cat_msgs_[cat].end(), msg_pool_.front());
-				auto hostIter = std::find(host_msgs_[host].begin(), host_msgs_[host].end(), msg_pool_.front());
-				auto appIter = std::find(app_msgs_[app].begin(), app_msgs_[app].end(), msg_pool_.front());
-				if (catIter != cat_msgs_[cat].end()) cat_msgs_[cat].erase(catIter);
-				if (hostIter != host_msgs_[host].end()) host_msgs_[host].erase(hostIter);
-				if (appIter != app_msgs_[app].end()) app_msgs_[app].erase(appIter);
-
-				if (app_msgs_[app].empty())
-				{
-					app_msgs_.erase(app);
-					app_list_update = true;
-				}
-				if (cat_msgs_[cat].empty())
-				{
-					cat_msgs_.erase(cat);
-					cat_list_update = true;
-				}
-				if (host_msgs_[host].empty())
-				{
-					host_msgs_.erase(host);
-					host_list_update = true;
-				}
-			}
+			// The oldest message is at the front of each of its index lists, so this does not depend on the pool size
+			auto const& oldest = msg_pool_.front();
+			auto position = msg_pool_.begin();
+			if (app_msgs_.evict(oldest->appId(), position)) app_changes_.remove(oldest->appId());
+			if (cat_msgs_.evict(oldest->catId(), position)) cat_changes_.remove(oldest->catId());
+			if (host_msgs_.evict(oldest->hostId(), position)) host_changes_.remove(oldest->hostId());
+			body_index_.evict(oldest->body(), position);
 
 			// Finally, remove the message from the pool so it doesn't appear in new filters
-			msg_pool_.erase(msg_pool_.begin());
+			msg_pool_.pop_front();
 			++nDeleted;
 		}
 	}
-	{
-		std::lock_guard<std::mutex> lk(msg_classification_mutex_);
-		if (host_list_update)
-			updateList(lwHost, host_msgs_);
-		if (app_list_update)
-			updateList(lwApplication, app_msgs_);
-		if (cat_list_update)
-			updateList(lwCategory, cat_msgs_);
-	}
 
 	for (size_t d = 0; d < msgFilters_.size(); ++d)
 	{
+		std::lock_guard<std::mutex> lk(filter_mutex_);
+		while (msgFilters_[d].msgs.size() > maxMsgs)
 		{
-			std::lock_guard<std::mutex> lk(filter_mutex_);
-			while (msgFilters_[d].msgs.size() > maxMsgs)
-			{
-				if ((*msgFilters_[d].msgs.begin())->sev() >= msgFilters_[d].sevThresh)
-					msgFilters_[d].nDisplayedDeletedMsgs++;
-				msgFilters_[d].msgs.erase(msgFilters_[d].msgs.begin());
-			}
-		}
-
-		if ((int)d == tabWidget->currentIndex())
-		{
-			if (maxDeletedMsgs > 0 && msgFilters_[d].nDisplayedDeletedMsgs > static_cast<int>(maxDeletedMsgs))
-			{
-				displayMsgs(d);
-			}
-			lcdDisplayedDeleted->display(msgFilters_[d].nDisplayedDeletedMsgs);
+			if ((*msgFilters_[d].msgs.begin())->sev() >= msgFilters_[d].sevThresh)
+				msgFilters_[d].nDisplayedDeletedMsgs++;
+			msgFilters_[d].msgs.erase(msgFilters_[d].msgs.begin());
 		}
 	}
-
-	lcdDeletedCount->display(nDeleted);
 }
 
-void msgViewerDlg::update_index(msg_ptr_t const& it)
+void msgViewerDlg::update_index(msg_ptr_t const& it, msg_position_t position)
 {
 	std::lock_guard<std::mutex> lk(msg_classification_mutex_);
-	QString const& app = it->app();
-	QString const& cat = it->cat();
-	QString const& host = it->host();
-
-	if (cat_msgs_.find(cat) == cat_msgs_.end())
-	{
-		cat_msgs_[cat].push_back(it);
-		updateList(lwCategory, cat_msgs_);
-	}
-	else
-	{
-		cat_msgs_[cat].push_back(it);
-	}
-
-	if (host_msgs_.find(host) == host_msgs_.end())
-	{
-		host_msgs_[host].push_back(it);
-		updateList(lwHost, host_msgs_);
-	}
-	else
-	{
-		host_msgs_[host].push_back(it);
-	}
-
-	if (app_msgs_.find(app) == app_msgs_.end())
-	{
-		app_msgs_[app].push_back(it);
-		updateList(lwApplication, app_msgs_);
-	}
-	else
-	{
-		app_msgs_[app].push_back(it);
-	}
+	if (cat_msgs_.add(it->catId(), position)) cat_changes_.add(it->catId());
+	if (host_msgs_.add(it->hostId(), position)) host_changes_.add(it->hostId());
+	if (app_msgs_.add(it->appId(), position)) app_changes_.add(it->appId());
+	body_index_.add(it->body(), position);
 }
 
 void msgViewerDlg::displayMsg(msg_ptr_t const& it, int display)
 {
 	if (it->sev() < msgFilters_[display].sevThresh) return;
 
+	// Shown at the next frame, by flushUpdates()
 	msgFilters_[display].nDisplayMsgs++;
-	if (display == tabWidget->currentIndex())
-	{
-		lcdDisplayedMsgs->display(msgFilters_[display].nDisplayMsgs);
-	}
-
-	auto txt = it->text(shortMode_);
-	QStringList txts;
-	txts.push_back(txt);
-	UpdateTextAreaDisplay(txts, msgFilters_[display].txtDisplay);
+	msgFilters_[display].pendingRows.push_back(it);
 }
 
 void msgViewerDlg::displayMsgs(int display)
 {
-	msgFilters_[display].txtDisplay->clear();
-	msgFilters_[display].nDisplayMsgs = 0;
-	msgFilters_[display].nDisplayedDeletedMsgs = 0;
-
-	QStringList txts;
 	{
 		std::lock_guard<std::mutex> lk(filter_mutex_);
-		for (auto it = msgFilters_[display].msgs.begin(); it != msgFilters_[display].msgs.end(); ++it)
-		{
-			if ((*it)->sev() >= msgFilters_[display].sevThresh)
-			{
-				txts.push_back((*it)->text(shortMode_));
-				++msgFilters_[display].nDisplayMsgs;
-			}
-		}
+		msgFilters_[display].model->setMessages(msgFilters_[display].msgs, msgFilters_[display].sevThresh);
 	}
+	msgFilters_[display].pendingRows.clear();  // already in msgs
+	msgFilters_[display].nDisplayMsgs = msgFilters_[display].model->rowCount();
+	msgFilters_[display].nDisplayedDeletedMsgs = 0;
+
 	if (display == tabWidget->currentIndex())
 	{
 		lcdDisplayedMsgs->display(msgFilters_[display].nDisplayMsgs);
+		if (!paused) scrollToBottom();
 	}
-	UpdateTextAreaDisplay(txts, msgFilters_[display].txtDisplay);
 }
 
-// https://stackoverflow.com/questions/13559990/how-to-append-text-to-qplaintextedit-without-adding-newline-and-keep-scroll-at
-void msgViewerDlg::UpdateTextAreaDisplay(QStringList const& texts, QPlainTextEdit* widget)
+void msgViewerDlg::setup_view(QListView* view, msgListModel* model)
 {
-	const QTextCursor old_cursor = widget->textCursor();
-	const int old_scrollbar_value = widget->verticalScrollBar()->value();
-	const bool is_scrolled_down =
-	    old_scrollbar_value >= widget->verticalScrollBar()->maximum() * 0.95;  // At least 95% scrolled down
+	view->setModel(model);
+	view->setItemDelegate(delegate_);
+	view->setUniformItemSizes(true);  // rows are never measured one by one
+	view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+	view->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+
+	// Rows show at most a few lines of a message; the detail pane shows all of the current one
+	connect(view->selectionModel(), SIGNAL(currentChanged(QModelIndex, QModelIndex)), this, SLOT(showDetail(QModelIndex)));
+
+	// Selected messages can be copied with the usual shortcut or from the context menu
+	auto copy = new QAction("Copy", view);
+	copy->setShortcut(QKeySequence::Copy);
+	copy->setShortcutContext(Qt::WidgetShortcut);
+	view->addAction(copy);
+	view->setContextMenuPolicy(Qt::ActionsContextMenu);
+	connect(copy, SIGNAL(triggered()), this, SLOT(copySelection()));
+}
 
-	if (!paused && !is_scrolled_down)
+void msgViewerDlg::copySelection()
+{
+	auto const& display = msgFilters_[tabWidget->currentIndex()];
+	auto rows = display.view->selectionModel()->selectedRows();
+	if (rows.isEmpty()) return;
+
+	// In the order shown, whatever order they were selected in
+	std::sort(rows.begin(), rows.end(), [](QModelIndex const& a, QModelIndex const& b) { return a.row() < b.row(); });
+	QStringList texts;
+	for (auto const& row : rows)
 	{
-		pause();
+		texts.push_back(display.model->message(row.row())->plainText(false));
 	}
+	QGuiApplication::clipboard()->setText(texts.join("\n\n"));
+}
 
-	QTextCursor new_cursor = QTextCursor(widget->document());
-
-	new_cursor.beginEditBlock();
-	new_cursor.movePosition(QTextCursor::End);
+void msgViewerDlg::showDetail(QModelIndex const& index)
+{
+	// Views of other tabs keep their own current rows; only the visible tab's is shown
+	auto const& display = msgFilters_[tabWidget->currentIndex()];
+	auto selection = qobject_cast<QItemSelectionModel*>(sender());
+	if (selection != nullptr && selection != display.view->selectionModel()) return;
 
-	for (int i = 0; i < texts.size(); i++)
+	if (!index.isValid())
 	{
-		new_cursor.insertBlock();
-		new_cursor.insertHtml(texts.at(i));
-		if (!shortMode_) new_cursor.insertBlock();
+		detailMsg_.reset();
+		txtDetail->clear();
+		return;
 	}
-	new_cursor.endEditBlock();
 
-	if (old_cursor.hasSelection() || paused)
-	{
-		// The user has selected text or scrolled away from the bottom: maintain position.
-		widget->setTextCursor(old_cursor);
-		widget->verticalScrollBar()->setValue(old_scrollbar_value);
-	}
-	else
-	{
-		// The user hasn't selected any text and the scrollbar is at the bottom: scroll to the bottom.
-		widget->moveCursor(QTextCursor::End);
-		widget->verticalScrollBar()->setValue(widget->verticalScrollBar()->maximum());
-		widget->horizontalScrollBar()->setValue(0);
-	}
+	// Rows dropped from the front of the model move the current index without changing its message
+	auto const& msg = display.model->message(index.row());
+	if (msg == detailMsg_) return;
+	detailMsg_ = msg;
+	txtDetail->setPlainText(msg->plainText(false));
 }
 
 void msgViewerDlg::scrollToBottom()
 {
 	int display = tabWidget->currentIndex();
-	msgFilters_[display].txtDisplay->moveCursor(QTextCursor::End);
-	msgFilters_[display].txtDisplay->verticalScrollBar()->setValue(
-	    msgFilters_[display].txtDisplay->verticalScrollBar()->maximum());
-	msgFilters_[display].txtDisplay->horizontalScrollBar()->setValue(0);
+	msgFilters_[display].view->scrollToBottom();
+	msgFilters_[display].view->horizontalScrollBar()->setValue(0);
 }
 
 void msgViewerDlg::updateDisplays()
@@ -572,63 +593,73 @@ void msgViewerDlg::updateDisplays()
 	}
 }
 
-bool msgViewerDlg::updateList(QListWidget* lw, msgs_map_t const& map)
+bool msgViewerDlg::updateList(QListWidget* lw, list_changes_t& changes)
 {
 	bool nonSelectedBefore = (lw->currentRow() == -1);
-	bool nonSelectedAfter = true;
-
-	QString item = nonSelectedBefore ? "" : lw->currentItem()->text();
 
-	lw->clear();
-	int row = 0;
-	auto it = map.begin();
+	for (auto id : changes.removed)
+	{
+		for (auto item : lw->findItems(qt_mf_msg::strings()[id], Qt::MatchExactly))
+		{
+			if (item == lw->currentItem()) lw->setCurrentRow(-1, QItemSelectionModel::Clear);
+			delete item;  // also takes it out of the list
+		}
+	}
 
-	while (it != map.end())
+	// Insert each new name at its place in alphabetical order
+	for (auto id : changes.added)
 	{
-		lw->addItem(it->first);
-		if (!nonSelectedBefore && nonSelectedAfter)
+		auto const& name = qt_mf_msg::strings()[id];
+		int row = 0;
+		int end = lw->count();
+		while (row < end)
 		{
-			if (item == it->first)
-			{
-				lw->setCurrentRow(row);
-				nonSelectedAfter = false;
-			}
+			int mid = (row + end) / 2;
+			if (lw->item(mid)->text() < name)
+				row = mid + 1;
+			else
+				end = mid;
 		}
-		++row;
-		++it;
+		lw->insertItem(row, name);
 	}
+	changes.clear();
 
-	if (!nonSelectedBefore && nonSelectedAfter) return true;
+	return !nonSelectedBefore && lw->currentRow() == -1;
+}
 
-	return false;
+std::vector<str_id_t> msgViewerDlg::toIds(QStringList const& names)
+{
+	std::vector<str_id_t> ids;
+	for (auto const& name : names)
+	{
+		str_id_t id;
+		if (qt_mf_msg::strings().find(name.toStdString(), id)) ids.push_back(id);
+	}
+	return ids;
 }
 
-msgs_t msgViewerDlg::list_intersect(msgs_t const& l1, msgs_t const& l2)
+bool msgViewerDlg::filter_match(std::vector<str_id_t> const& ids, str_id_t id)
 {
-	msgs_t output;
-	auto it1 = l1.begin();
-	auto it2 = l2.begin();
+	return ids.empty() || std::find(ids.begin(), ids.end(), id) != ids.end();
+}
 
-	while (it1 != l1.end() && it2 != l2.end())
+std::shared_ptr<mfviewer::detail::BodyPattern const> msgViewerDlg::sharedBodyPattern(QString const& pattern)
+{
+	for (auto const& display : msgFilters_)
 	{
-		if (*it1 < *it2)
-		{
-			++it1;
-		}
-		else if (*it2 < *it1)
-		{
-			++it2;
-		}
-		else
-		{
-			output.push_back(*it1);
-			++it1;
-			++it2;
-		}
+		if (display.bodyPattern && display.bodyPattern->pattern() == pattern.toStdString()) return display.bodyPattern;
 	}
 
-	TLOG(TLVL_DEBUG + 35) << "list_intersect: output list has " << output.size() << " entries";
-	return output;
+	try
+	{
+		return std::make_shared<mfviewer::detail::BodyPattern const>(pattern.toStdString());
+	}
+	catch (boost::regex_error const& e)
+	{
+		TLOG(TLVL_WARNING) << "Invalid body filter \"" << pattern.toStdString() << "\": " << e.what();
+		QMessageBox::warning(this, tr("Message Viewer"), tr("Invalid body filter: %1").arg(e.what()));
+		return nullptr;
+	}
 }
 
 std::string sev_to_string(sev_code_t s)
@@ -652,12 +683,13 @@ void msgViewerDlg::setFilter()
 	auto hostFilter = toQStringList(lwHost->selectedItems());
 	auto appFilter = toQStringList(lwApplication->selectedItems());
 	auto catFilter = toQStringList(lwCategory->selectedItems());
+	auto bodyFilter = editBodyFilter->text();
 
 	lwHost->setCurrentRow(-1, QItemSelectionModel::Clear);
 	lwApplication->setCurrentRow(-1, QItemSelectionModel::Clear);
 	lwCategory->setCurrentRow(-1, QItemSelectionModel::Clear);
 
-	if (hostFilter.isEmpty() && appFilter.isEmpty() && catFilter.isEmpty())
+	if (hostFilter.isEmpty() && appFilter.isEmpty() && catFilter.isEmpty() && bodyFilter.isEmpty())
 	{
 		return;
 	}
@@ -711,6 +743,11 @@ void msgViewerDlg::setFilter()
 		                   (hostFilterExpression != "" && appFilterExpression != "" ? ") && (" : "") + appFilterExpression +
 		                   ")";
 	}
+	if (!bodyFilter.isEmpty())
+	{
+		auto bodyFilterExpression = "body =~ /" + bodyFilter + "/";
+		filterExpression = nFilterExpressions == 0 ? bodyFilterExpression : "(" + filterExpression + ") && " + bodyFilterExpression;
+	}
 
 	for (size_t d = 0; d < msgFilters_.size(); ++d)
 	{
@@ -721,67 +758,40 @@ void msgViewerDlg::setFilter()
 		}
 	}
 
+	std::shared_ptr<mfviewer::detail::BodyPattern const> bodyPattern;
+	if (!bodyFilter.isEmpty())
 	{
-		std::lock_guard<std::mutex> lk(msg_classification_mutex_);
-		for (auto app = 0; app < appFilter.size(); ++app)
-		{  // app-sev index
-			auto it = app_msgs_.find(appFilter[app]);
-			if (it != app_msgs_.end())
-			{
-				msgs_t temp(it->second);
-				TLOG(TLVL_DEBUG + 35) << "setFilter: app " << appFilter[app].toStdString() << " has " << temp.size() << " messages";
-				result.merge(temp);
-			}
-		}
-		TLOG(TLVL_DEBUG + 35) << "setFilter: result contains " << result.size() << " messages";
+		bodyPattern = sharedBodyPattern(bodyFilter);
+		if (!bodyPattern) return;
+		editBodyFilter->clear();
+	}
 
-		if (!hostFilter.isEmpty())
-		{
-			msgs_t hostResult;
-			for (auto host = 0; host < hostFilter.size(); ++host)
-			{  // host index
-				auto it = host_msgs_.find(hostFilter[host]);
-				if (it != host_msgs_.end())
-				{
-					msgs_t temp(it->second);
-					TLOG(TLVL_DEBUG + 35) << "setFilter: host " << hostFilter[host].toStdString() << " has " << temp.size() << " messages";
-					hostResult.merge(temp);
-				}
-			}
-			if (result.empty())
-			{
-				result = hostResult;
-			}
-			else
-			{
-				result = list_intersect(result, hostResult);
-			}
-			TLOG(TLVL_DEBUG + 35) << "setFilter: result contains " << result.size() << " messages";
-		}
+	auto hostIds = toIds(hostFilter);
+	auto appIds = toIds(appFilter);
+	auto catIds = toIds(catFilter);
+	{
+		std::lock_guard<std::mutex> lk(msg_classification_mutex_);
 
-		if (!catFilter.isEmpty())
+		// A message passes if it matches any selected name in every list with a selection. Names which no stored
+		// message has leave a nullptr in their group, so a selection of only such names matches nothing.
+		auto group = [](msg_index_t const& index, QStringList const& filter, std::vector<str_id_t> const& ids) {
+			std::vector<mfviewer::detail::PositionBitmap const*> bitmaps;
+			for (auto id : ids) bitmaps.push_back(index.find(id));
+			if (!filter.isEmpty() && bitmaps.empty()) bitmaps.push_back(nullptr);
+			return bitmaps;
+		};
+		auto positions = mfviewer::detail::select_positions({group(app_msgs_, appFilter, appIds), group(host_msgs_, hostFilter, hostIds),
+		                                                     group(cat_msgs_, catFilter, catIds)},
+		                                                    msg_pool_.begin(), msg_pool_.end());
+
+		// Then the body pattern, over the messages left, on all cores
+		if (bodyPattern)
 		{
-			msgs_t catResult;
-			for (auto cat = 0; cat < catFilter.size(); ++cat)
-			{  // cat index
-				auto it = cat_msgs_.find(catFilter[cat]);
-				if (it != cat_msgs_.end())
-				{
-					msgs_t temp(it->second);
-					TLOG(TLVL_DEBUG + 35) << "setFilter: cat " << catFilter[cat].toStdString() << " has " << temp.size() << " messages";
-					catResult.merge(temp);
-				}
-			}
-			if (result.empty())
-			{
-				result = catResult;
-			}
-			else
-			{
-				result = list_intersect(result, catResult);
-			}
-			TLOG(TLVL_DEBUG + 35) << "setFilter: result contains " << result.size() << " messages";
+			positions = mfviewer::detail::parallel_select(*bodyPattern, positions,
+			                                              [this](msg_position_t position) { return msg_pool_[position]->body(); });
 		}
+		for (auto position : positions) result.push_back(msg_pool_[position]);
+		TLOG(TLVL_DEBUG + 35) << "setFilter: result contains " << result.size() << " messages";
 	}
 
 	// Add the tab and populate it
@@ -789,12 +799,13 @@ void msgViewerDlg::setFilter()
 	auto newTabTitle = QString("Filter ") + QString::number(++nFilters);
 	auto newTab = new QWidget();
 
-	auto txtDisplay = new QPlainTextEdit(newTab);
-	auto doc = new QTextDocument(txtDisplay);
-	txtDisplay->setDocument(doc);
+	auto view = new QListView(newTab);
+	view->setFont(lvMessages->font());
+	auto model = new msgListModel(view);
+	setup_view(view, model);
 
 	auto layout = new QVBoxLayout();
-	layout->addWidget(txtDisplay);
+	layout->addWidget(view);
 	layout->setContentsMargins(0, 0, 0, 0);
 	newTab->setLayout(layout);
 
@@ -803,8 +814,13 @@ void msgViewerDlg::setFilter()
 	filteredMessages.hostFilter = hostFilter;
 	filteredMessages.appFilter = appFilter;
 	filteredMessages.catFilter = catFilter;
+	filteredMessages.hostIds = hostIds;
+	filteredMessages.appIds = appIds;
+	filteredMessages.catIds = catIds;
+	filteredMessages.bodyPattern = bodyPattern;
 	filteredMessages.filterExpression = filterExpression;
-	filteredMessages.txtDisplay = txtDisplay;
+	filteredMessages.view = view;
+	filteredMessages.model = model;
 	filteredMessages.nDisplayMsgs = result.size();
 	filteredMessages.nDisplayedDeletedMsgs = 0;
 	filteredMessages.sevThresh = SINFO;
@@ -858,21 +874,27 @@ void msgViewerDlg::clear()
 				host_msgs_.clear();
 				cat_msgs_.clear();
 				app_msgs_.clear();
-				updateList(lwApplication, app_msgs_);
-				updateList(lwCategory, cat_msgs_);
-				updateList(lwHost, host_msgs_);
+				body_index_.clear();
+				app_changes_.clear();
+				cat_changes_.clear();
+				host_changes_.clear();
+				lwApplication->clear();
+				lwCategory->clear();
+				lwHost->clear();
 			}
 			for (auto& display : msgFilters_)
 			{
 				std::lock_guard<std::mutex> lk(filter_mutex_);
-				display.txtDisplay->clear();
+				display.model->clear();
+				display.pendingRows.clear();
 				display.msgs.clear();
 				display.nDisplayMsgs = 0;
 				display.nDisplayedDeletedMsgs = 0;
 			}
+			detailMsg_.reset();
+			txtDetail->clear();
 
-			lcdMsgs->display(nMsgs);
-			lcdDisplayedMsgs->display(0);
+			flushUpdates();
 			break;
 		case QMessageBox::No:
 		default:
@@ -892,6 +914,7 @@ void msgViewerDlg::shortMode()
 		shortMode_ = false;
 		btnDisplayMode->setText("Compact View");
 	}
+	delegate_->setShortMode(shortMode_);
 	updateDisplays();
 }
 
@@ -967,19 +990,8 @@ void msgViewerDlg::renderMode()
 {
 	simpleRender = !simpleRender;
 
-	if (simpleRender)
-	{
-		btnRMode->setChecked(true);
-		for (auto display : msgFilters_)
-		{
-			display.txtDisplay->setPlainText(display.txtDisplay->toPlainText());
-		}
-	}
-	else
-	{
-		btnRMode->setChecked(false);
-		updateDisplays();
-	}
+	// Rows are always drawn as plain text in their severity color
+	btnRMode->setChecked(simpleRender);
 }
 
 void msgViewerDlg::searchMsg()
@@ -988,30 +1000,55 @@ void msgViewerDlg::searchMsg()
 
 	if (search.isEmpty()) return;
 
+	// Messages not shown yet have no rows to jump to
+	flushUpdates();
+
 	auto display = tabWidget->currentIndex();
 	if (search != searchStr)
 	{
-		msgFilters_[display].txtDisplay->moveCursor(QTextCursor::Start);
-		if (!msgFilters_[display].txtDisplay->find(search))
-		{
-			msgFilters_[display].txtDisplay->moveCursor(QTextCursor::End);
-			searchStr = "";
-		}
-		else
-			searchStr = search;
+		searchStr = search;
+		searchPosition_ = 0;
 	}
-	else
+
+	// Look through the whole pool with the index, then step to the next match shown in this tab
+	auto query = search.toStdString();
+	auto model = msgFilters_[display].model;
+	std::vector<std::pair<msg_position_t, int>> shown;  // matches in this tab, with their rows
+	size_t nHits = 0;
 	{
-		if (!msgFilters_[display].txtDisplay->find(search))
+		std::lock_guard<std::mutex> lk(msg_classification_mutex_);
+		auto hits = body_index_.search(query, msg_pool_.begin(), msg_pool_.end(),
+		                               [this](msg_position_t position) { return msg_pool_[position]->body(); });
+		nHits = hits.size();
+		for (auto position : hits)
 		{
-			msgFilters_[display].txtDisplay->moveCursor(QTextCursor::Start);
-			if (!msgFilters_[display].txtDisplay->find(search))
-			{
-				msgFilters_[display].txtDisplay->moveCursor(QTextCursor::End);
-				searchStr = "";
-			}
+			auto row = model->rowOf(msg_pool_[position]->seq());
+			if (row >= 0) shown.emplace_back(position, row);
 		}
 	}
+	TLOG(TLVL_DEBUG + 35) << "searchMsg: " << nHits << " messages match \"" << query << "\", " << shown.size() << " of them in display " << display;
+
+	lblSearchHits->setToolTip(QString("%1 messages in the buffer match \"%2\"; %3 of them are shown in this tab")
+	                              .arg(nHits)
+	                              .arg(search)
+	                              .arg(shown.size()));
+	if (shown.empty())
+	{
+		lblSearchHits->setText(QString("%1 in buffer").arg(nHits));
+		return;
+	}
+
+	// The next match after the last one jumped to, wrapping around to the oldest
+	auto next = std::find_if(shown.begin(), shown.end(), [this](std::pair<msg_position_t, int> const& hit) { return hit.first >= searchPosition_; });
+	if (next == shown.end()) next = shown.begin();
+	searchPosition_ = next->first + 1;
+	lblSearchHits->setText(QString("%1 of %2").arg(next - shown.begin() + 1).arg(shown.size()));
+
+	// Select the message, and stop scrolling so that new messages do not move it away
+	if (!paused) pause();
+	auto index = model->index(next->second);
+	msgFilters_[display].view->setCurrentIndex(index);
+	msgFilters_[display].view->scrollTo(index, QAbstractItemView::PositionAtCenter);
 }
 
 void msgViewerDlg::searchClear()
@@ -1019,8 +1056,11 @@ void msgViewerDlg::searchClear()
 	auto display = tabWidget->currentIndex();
 	editSearch->setText("");
 	searchStr = "";
-	msgFilters_[display].txtDisplay->find("");
-	msgFilters_[display].txtDisplay->moveCursor(QTextCursor::End);
+	searchPosition_ = 0;
+	lblSearchHits->setText("");
+	lblSearchHits->setToolTip("");
+	msgFilters_[display].view->clearSelection();
+	msgFilters_[display].view->scrollToBottom();
 }
 
 void msgViewerDlg::setSuppression(QAction* act)
@@ -1039,8 +1079,11 @@ void msgViewerDlg::setThrottling(QAction* act)
 
 void msgViewerDlg::tabWidgetCurrentChanged(int newTab)
 {
-	displayMsgs(newTab);
+	// Every tab's rows are kept up to date, so there is nothing to redraw
 	lcdDisplayedMsgs->display(msgFilters_[newTab].nDisplayMsgs);
+	lcdDisplayedDeleted->display(msgFilters_[newTab].nDisplayedDeletedMsgs);
+	if (!paused) scrollToBottom();
+	showDetail(msgFilters_[newTab].view->currentIndex());
 
 	lwHost->setCurrentRow(-1, QItemSelectionModel::Clear);
 	lwApplication->setCurrentRow(-1, QItemSelectionModel::Clear);
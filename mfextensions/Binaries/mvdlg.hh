@@ -1,9 +1,14 @@
 #ifndef MSGVIEWERDLG_H
 #define MSGVIEWERDLG_H
 
+#include "mfextensions/Binaries/mvmodel.hh"
 #include "mfextensions/Extensions/suppress.hh"
 #include "mfextensions/Extensions/throttle.hh"
-#include "mfextensions/Receivers/ReceiverManager.hh"
+#include "mfextensions/Receivers/QtReceiverAdaptor.hh"
+#include "mfextensions/Receivers/detail/BodyPattern.hh"
+#include "mfextensions/Receivers/detail/MessageRing.hh"
+#include "mfextensions/Receivers/detail/PositionBitmap.hh"
+#include "mfextensions/Receivers/detail/TextIndex.hh"
 #include "mfextensions/Receivers/qt_mf_msg.hh"
 #include "ui_msgviewerdlgui.h"
 
@@ -12,8 +17,11 @@
 
 #include <boost/regex.hpp>
 
+#include <chrono>
 #include <list>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -64,7 +72,7 @@ protected:
 
 private slots:
 
-	void onNewMsg(msg_ptr_t const& mfmsg);
+	void onNewMsgs(msg_batch_t const& mfmsgs);
 
 	void setFilter();
 
@@ -92,9 +100,47 @@ private slots:
 
 	void scrollToBottom();
 
+	// Copy the full text of the selected messages of the current tab to the clipboard
+	void copySelection();
+
+	// Show the whole of the current tab's current message in the detail pane
+	void showDetail(QModelIndex const& index);
+
+	// Apply the changes collected since the last frame to the widgets
+	void flushUpdates();
+
 	//---------------------------------------------------------------------------
 
 private:
+	// Position of a message in msg_pool_, and index from an interned host/category/application to positions
+	typedef mfviewer::detail::MessageRing<msg_ptr_t>::position_t msg_position_t;
+	typedef mfviewer::detail::BitmapIndex<str_id_t> msg_index_t;
+
+	// Names to add to and remove from a host/category/application list at the next frame
+	struct list_changes_t
+	{
+		std::set<str_id_t> added;
+		std::set<str_id_t> removed;
+
+		// A name first used by a message; undoes a removal not yet shown
+		void add(str_id_t id)
+		{
+			if (removed.erase(id) == 0) added.insert(id);
+		}
+
+		// A name no longer used by any message; undoes an addition not yet shown
+		void remove(str_id_t id)
+		{
+			if (added.erase(id) == 0) removed.insert(id);
+		}
+
+		void clear()
+		{
+			added.clear();
+			removed.clear();
+		}
+	};
+
 	msgViewerDlg(msgViewerDlg const&) = delete;
 	msgViewerDlg(msgViewerDlg&&) = delete;
 	msgViewerDlg& operator=(msgViewerDlg const&) = delete;
@@ -103,21 +149,28 @@ private:
 	// Display all messages stored in the buffer
 	void displayMsgs(int display);
 
-	void UpdateTextAreaDisplay(QStringList const& texts, QPlainTextEdit* widget);
+	// Show a tab's model in a view, drawn by delegate_
+	void setup_view(QListView* view, msgListModel* model);
 
 	void updateDisplays();
 
 	void trim_msg_pool();
 
+	// Show how many messages the receivers have shed, at most once a second
+	void update_shed_count();
+
+	// Add a message to the pool, the indices and the filtered displays
+	void add_msg(msg_ptr_t const& mfmsg);
+
 	// test if the message is suppressed or throttled
 	bool msg_throttled(msg_ptr_t const& mfmsg);
 
-	void update_index(msg_ptr_t const& msg);
+	void update_index(msg_ptr_t const& msg, msg_position_t position);
 
-	// Update the list. Returns true if there's a change in the selection
-	// before and after the update. e.g., the selected entry has been deleted
-	// during the process of updateMap(); otherwise it returns a false.
-	bool updateList(QListWidget* lw, msgs_map_t const& map);
+	// Insert and remove the changed names in the list, keeping it in alphabetical order, and forget the changes.
+	// Returns true if there's a change in the selection before and after the update, e.g., the selected entry has
+	// been removed; otherwise it returns a false.
+	bool updateList(QListWidget* lw, list_changes_t& changes);
 
 	void displayMsg(msg_ptr_t const& msg, int display);
 
@@ -129,7 +182,15 @@ private:
 
 	QStringList toQStringList(QList<QListWidgetItem*> in);
 
-	msgs_t list_intersect(msgs_t const& l1, msgs_t const& l2);
+	// Handles of the given names, skipping names which no message has used
+	static std::vector<str_id_t> toIds(QStringList const& names);
+
+	// Whether a message field passes a filter on the given handles; an empty filter passes everything
+	static bool filter_match(std::vector<str_id_t> const& ids, str_id_t id);
+
+	// The compiled body pattern of an existing tab, or a newly compiled one; nullptr (after telling the user) if the
+	// pattern is not a valid regular expression
+	std::shared_ptr<mfviewer::detail::BodyPattern const> sharedBodyPattern(QString const& pattern);
 
 	//---------------------------------------------------------------------------
 
@@ -146,9 +207,25 @@ private:
 	size_t maxDeletedMsgs;  // Maximum number of deleted messages to display
 	int nDeleted;
 
+	// Messages dropped by the receivers while the display fell behind, and when that was last checked
+	size_t nShed = 0;
+	std::chrono::steady_clock::time_point lastShedCheck_;
+
+	// Widgets are updated once a frame, at most ui_update_rate times a second, with what changed in between
+	QTimer uiTimer_;
+	list_changes_t host_changes_;
+	list_changes_t cat_changes_;
+	list_changes_t app_changes_;
+
 	// Rendering messages in speed mode or full mode
 	bool simpleRender;
 
+	// Draws the rows of every tab
+	msgItemDelegate* delegate_;
+
+	// Message shown in the detail pane, so that the pane is only refilled when the current message changes
+	msg_ptr_t detailMsg_;
+
 	// suppression regex
 	std::vector<suppress> e_sup_host;
 	std::vector<suppress> e_sup_app;
@@ -159,25 +236,27 @@ private:
 	std::vector<throttle> e_thr_app;
 	std::vector<throttle> e_thr_cat;
 
-	// search string
+	// search string, and the pool position after the last match jumped to
 	QString searchStr;
+	msg_position_t searchPosition_;
 
 	// msg pool storing the formatted text body
 	mutable std::mutex msg_pool_mutex_;
-	msgs_t msg_pool_;
+	mfviewer::detail::MessageRing<msg_ptr_t> msg_pool_;
 
 	// map of a key to a list of msg iters
 	mutable std::mutex msg_classification_mutex_;
-	msgs_map_t host_msgs_;
-	msgs_map_t cat_msgs_;
-	msgs_map_t app_msgs_;
+	msg_index_t host_msgs_;
+	msg_index_t cat_msgs_;
+	msg_index_t app_msgs_;
+	mfviewer::detail::TextIndex body_index_;
 
 	// context menu for "suppression" and "throttling" button
 	QMenu* sup_menu;
 	QMenu* thr_menu;
 
 	// Receiver Plugin Manager
-	mfviewer::ReceiverManager receivers_;
+	mfviewer::QtReceiverAdaptor receivers_;
 
 	mutable std::mutex filter_mutex_;
 	struct MsgFilterDisplay
@@ -188,8 +267,14 @@ private:
 		QStringList hostFilter;
 		QStringList appFilter;
 		QStringList catFilter;
+		std::vector<str_id_t> hostIds;
+		std::vector<str_id_t> appIds;
+		std::vector<str_id_t> catIds;
+		std::shared_ptr<mfviewer::detail::BodyPattern const> bodyPattern;  // shared by the tabs with the same pattern
 		QString filterExpression;
-		QPlainTextEdit* txtDisplay;
+		QListView* view;
+		msgListModel* model;                 // the messages at or above sevThresh
+		std::vector<msg_ptr_t> pendingRows;  // messages to add to model at the next frame
 
 		// severity threshold
 		sev_code_t sevThresh;
@@ -0,0 +1,155 @@
+#include "mfextensions/Binaries/mvmodel.hh"
+
+#include <QtGui/QFontMetrics>
+#include <QtGui/QPainter>
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QStyle>
+
+#include <algorithm>
+
+namespace {
+// Layouts kept for drawing; a few screens' worth of rows
+int constexpr cached_layouts = 4096;
+
+// Space around the text of a row, in pixels
+int constexpr margin = 2;
+}  // namespace
+
+msgListModel::msgListModel(QObject* parent)
+    : QAbstractListModel(parent), first_(0) {}
+
+int msgListModel::rowCount(QModelIndex const& parent) const { return parent.isValid() ? 0 : static_cast<int>(rows_.size()); }
+
+QVariant msgListModel::data(QModelIndex const& index, int role) const
+{
+	if (!index.isValid() || index.row() >= rowCount()) return QVariant();
+
+	auto const& msg = message(index.row());
+	switch (role)
+	{
+		case Qt::DisplayRole:
+			return msg->plainText(false);
+		case Qt::ToolTipRole:
+			return msg->text(false);
+		case Qt::ForegroundRole:
+			return msg->color();
+		default:
+			return QVariant();
+	}
+}
+
+void msgListModel::setMessages(msgs_t const& msgs, sev_code_t sevThresh)
+{
+	beginResetModel();
+	rows_.clear();
+	serials_.clear();
+	first_ = 0;
+	for (auto const& msg : msgs)
+	{
+		if (msg->sev() < sevThresh) continue;
+		serials_[msg->seq()] = rows_.size();
+		rows_.push_back(msg);
+	}
+	endResetModel();
+}
+
+void msgListModel::append(std::vector<msg_ptr_t> const& msgs)
+{
+	if (msgs.empty()) return;
+
+	auto row = rowCount();
+	beginInsertRows(QModelIndex(), row, row + static_cast<int>(msgs.size()) - 1);
+	for (auto const& msg : msgs)
+	{
+		serials_[msg->seq()] = first_ + rows_.size();
+		rows_.push_back(msg);
+	}
+	endInsertRows();
+}
+
+void msgListModel::dropFront(int count)
+{
+	count = std::min(count, rowCount());
+	if (count <= 0) return;
+
+	beginRemoveRows(QModelIndex(), 0, count - 1);
+	for (int ii = 0; ii < count; ++ii)
+	{
+		serials_.erase(rows_.front()->seq());
+		rows_.pop_front();
+	}
+	first_ += count;
+	endRemoveRows();
+}
+
+void msgListModel::clear() { setMessages(msgs_t(), SDEBUG); }
+
+int msgListModel::rowOf(size_t seq) const
+{
+	auto it = serials_.find(seq);
+	return it == serials_.end() ? -1 : static_cast<int>(it->second - first_);
+}
+
+msgItemDelegate::msgItemDelegate(QObject* parent)
+    : QStyledItemDelegate(parent), shortMode_(false), layouts_(cached_layouts) {}
+
+void msgItemDelegate::setShortMode(bool shortMode)
+{
+	shortMode_ = shortMode;
+	layouts_.clear();
+}
+
+void msgItemDelegate::paint(QPainter* painter, QStyleOptionViewItem const& option, QModelIndex const& index) const
+{
+	auto model = qobject_cast<msgListModel const*>(index.model());
+	if (model == nullptr)
+	{
+		QStyledItemDelegate::paint(painter, option, index);
+		return;
+	}
+
+	// Selection and focus background, as the style draws them
+	auto style = option.widget != nullptr ? option.widget->style() : QApplication::style();
+	style->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, option.widget);
+
+	auto const& msg = model->message(index.row());
+	painter->save();
+	painter->setClipRect(option.rect);
+	painter->setPen(msg->color());
+	layout_(*msg, option.font)->draw(painter, QPointF(option.rect.left() + margin, option.rect.top() + margin));
+	painter->restore();
+}
+
+QSize msgItemDelegate::sizeHint(QStyleOptionViewItem const& option, QModelIndex const& /*index*/) const
+{
+	// In long mode, a blank line separates the messages
+	auto lines = shortMode_ ? lines_() : lines_() + 1;
+	return QSize(option.rect.width(), lines * QFontMetrics(option.font).lineSpacing() + 2 * margin);
+}
+
+QTextLayout const* msgItemDelegate::layout_(qt_mf_msg const& msg, QFont const& font) const
+{
+	auto layout = layouts_.object(msg.seq());
+	if (layout != nullptr) return layout;
+
+	// Keep the lines that fit in a row, and show that the rest of the body has been cut
+	auto lines = msg.plainText(shortMode_).split('\n');
+	if (lines.size() > lines_())
+	{
+		lines.erase(lines.begin() + lines_(), lines.end());
+		lines.back() += " ...";
+	}
+
+	layout = new QTextLayout(lines.join(QChar::LineSeparator), font);
+	layout->beginLayout();
+	qreal y = 0;
+	for (auto line = layout->createLine(); line.isValid(); line = layout->createLine())
+	{
+		line.setLineWidth(1e6);  // only break at the line separators
+		line.setPosition(QPointF(0, y));
+		y += line.height();
+	}
+	layout->endLayout();
+	layouts_.insert(msg.seq(), layout);
+	return layout;
+}
@@ -0,0 +1,113 @@
+#ifndef MSGVIEWERMODEL_H
+#define MSGVIEWERMODEL_H
+
+#include "mfextensions/Receivers/qt_mf_msg.hh"
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QCache>
+#include <QtGui/QTextLayout>
+#include <QtWidgets/QStyledItemDelegate>
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// List model over the messages shown in one message viewer tab
+///
+/// Rows hold the messages, oldest first. Views only ask for the rows they show, so appending rows, dropping the
+/// oldest ones and scrolling cost the same however many messages the tab holds.
+/// </summary>
+class msgListModel : public QAbstractListModel
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * \brief msgListModel Constructor
+	 * \param parent Owner of the model
+	 */
+	explicit msgListModel(QObject* parent = nullptr);
+
+	/// Number of rows
+	int rowCount(QModelIndex const& parent = QModelIndex()) const override;
+
+	/// Plain text (Qt::DisplayRole), full HTML text (Qt::ToolTipRole) or severity color (Qt::ForegroundRole) of a row
+	QVariant data(QModelIndex const& index, int role) const override;
+
+	/**
+	 * \brief Replace all rows
+	 * \param msgs Messages of the tab
+	 * \param sevThresh Lowest severity to show
+	 */
+	void setMessages(msgs_t const& msgs, sev_code_t sevThresh);
+
+	/**
+	 * \brief Add messages as the last rows, in one insertion
+	 * \param msgs Messages to add, oldest first
+	 */
+	void append(std::vector<msg_ptr_t> const& msgs);
+
+	/**
+	 * \brief Remove the oldest rows
+	 * \param count Number of rows to remove
+	 */
+	void dropFront(int count);
+
+	/// Remove all rows
+	void clear();
+
+	/// The message in a row
+	msg_ptr_t const& message(int row) const { return rows_[static_cast<size_t>(row)]; }
+
+	/// Row of the message with a sequence number, or -1 if it is not shown
+	int rowOf(size_t seq) const;
+
+private:
+	std::deque<msg_ptr_t> rows_;
+	std::unordered_map<size_t, uint64_t> serials_;  // sequence number of each row's message to the row's serial
+	uint64_t first_;                                // serial of row 0; serials count every row ever appended
+};
+
+/// <summary>
+/// Draws the rows of a msgListModel as plain text in the color of their severity.
+///
+/// Every row has the same height: one line in short mode, and the message header plus one body line in long mode,
+/// with longer bodies cut short (the viewer's detail pane and the tooltip show the whole message). Views can then use
+/// uniform item sizes and never measure rows they do not show. The text layouts of recently drawn rows are cached.
+/// </summary>
+class msgItemDelegate : public QStyledItemDelegate
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * \brief msgItemDelegate Constructor
+	 * \param parent Owner of the delegate
+	 */
+	explicit msgItemDelegate(QObject* parent = nullptr);
+
+	/**
+	 * \brief Switch between short and long mode
+	 * \param shortMode Whether to draw the short form of the messages
+	 */
+	void setShortMode(bool shortMode);
+
+	/// Draw a row
+	void paint(QPainter* painter, QStyleOptionViewItem const& option, QModelIndex const& index) const override;
+
+	/// Size of every row
+	QSize sizeHint(QStyleOptionViewItem const& option, QModelIndex const& index) const override;
+
+private:
+	int lines_() const { return shortMode_ ? 1 : 6; }
+
+	// The laid-out text of a message, from the cache or newly made
+	QTextLayout const* layout_(qt_mf_msg const& msg, QFont const& font) const;
+
+	bool shortMode_;
+	mutable QCache<size_t, QTextLayout> layouts_;  // by message sequence number
+};
+
+#endif
@@ -13,12 +13,25 @@
 #include <ifaddrs.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <sys/socket.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "mfextensions/Destinations/detail/UDPTextFormat.hh"
+#include "mfextensions/Destinations/detail/WritableWaiter.hh"
 #include "mfextensions/Receivers/detail/TCPConnect.hh"
+#include "mfextensions/Receivers/detail/UDPWireFormat.hh"
 
 #define TRACE_NAME "UDP_mfPlugin"
 #include "trace.h"
@@ -69,6 +82,50 @@ public:
 		fhicl::Atom<std::string> filename_delimit =
 		    fhicl::Atom<std::string>{fhicl::Name{"filename_delimit"},
 		                             fhicl::Comment{"Grab path after this. \"/srcs/\" /x/srcs/y/z.cc => y/z.cc. NOTE: only works if full filename is given to this plugin (based on which mf::<method> is used)."}, "/"};
+		/// "async_send" (Default: false): Send messages from a dedicated thread using a non-blocking socket
+		fhicl::Atom<bool> async_send = fhicl::Atom<bool>{
+		    fhicl::Name{"async_send"},
+		    fhicl::Comment{"Queue messages and send them from a dedicated thread using a non-blocking socket, so that logging threads never wait on the network"}, false};
+		/// "async_queue_size" (Default: 10000): Maximum number of messages waiting to be sent in async mode
+		fhicl::Atom<size_t> async_queue_size = fhicl::Atom<size_t>{
+		    fhicl::Name{"async_queue_size"},
+		    fhicl::Comment{"Maximum number of messages waiting to be sent in async mode. Messages arriving while the queue is full are dropped and counted"}, 10000};
+		/// "drain_timeout_ms" (Default: 1000): How long, in total, the async sender keeps retrying full socket buffers while flushing its queue at shutdown
+		fhicl::Atom<int> drain_timeout_ms = fhicl::Atom<int>{
+		    fhicl::Name{"drain_timeout_ms"},
+		    fhicl::Comment{"When the destination is destroyed in async mode, the messages still queued are sent, waiting for room in the socket buffer for at most this long (ms) in total. Messages left when it runs out are dropped"}, 1000};
+		/// "socket_send_buffer_size" (Default: 0): Size of the socket send buffer (SO_SNDBUF), 0 to use the system default
+		fhicl::Atom<int> socket_send_buffer_size = fhicl::Atom<int>{
+		    fhicl::Name{"socket_send_buffer_size"},
+		    fhicl::Comment{"Size of the socket send buffer (SO_SNDBUF) in bytes. 0 to use the system default"}, 0};
+		/// "batch_size" (Default: 1): Maximum number of datagrams sent per sendmmsg call. Values above 1 imply async_send
+		fhicl::Atom<size_t> batch_size = fhicl::Atom<size_t>{
+		    fhicl::Name{"batch_size"},
+		    fhicl::Comment{"Maximum number of datagrams handed to the kernel in one sendmmsg call. Values above 1 enable batching (and imply async_send)"}, 1};
+		/// "batch_linger_ms" (Default: 5): How long the sender thread waits for a batch to fill before flushing it
+		fhicl::Atom<int> batch_linger_ms = fhicl::Atom<int>{
+		    fhicl::Name{"batch_linger_ms"},
+		    fhicl::Comment{"How long (ms) the sender thread waits for batch_size messages to accumulate before flushing a partial batch"}, 5};
+		/// "pack_messages" (Default: false): Pack several messages into each datagram. Implies async_send
+		fhicl::Atom<bool> pack_messages = fhicl::Atom<bool>{
+		    fhicl::Name{"pack_messages"},
+		    fhicl::Comment{"Pack several length-prefixed messages into each datagram, up to max_datagram_size (implies async_send). Requires a receiver that understands the framed format"}, false};
+		/// "max_datagram_size" (Default: 1472): Largest datagram built when packing messages
+		fhicl::Atom<size_t> max_datagram_size = fhicl::Atom<size_t>{
+		    fhicl::Name{"max_datagram_size"},
+		    fhicl::Comment{"Largest datagram (in bytes) built when pack_messages is enabled. The default fits a 1500-byte Ethernet MTU"}, 1472};
+		/// "wire_format" (Default: "text"): Encoding of each message, "text" (pipe-delimited) or "binary"
+		fhicl::Atom<std::string> wire_format = fhicl::Atom<std::string>{
+		    fhicl::Name{"wire_format"},
+		    fhicl::Comment{"Encoding of each message: \"text\" (pipe-delimited, understood by all receivers), \"binary\" (compact) or \"dictionary\" (binary, with repeated strings replaced by ids announced separately). The latter two require a receiver that understands them"}, "text"};
+		/// "dictionary_refresh_s" (Default: 30): How often the full string table is re-announced in dictionary mode
+		fhicl::Atom<int> dictionary_refresh_s = fhicl::Atom<int>{
+		    fhicl::Name{"dictionary_refresh_s"},
+		    fhicl::Comment{"In dictionary mode, how often (seconds) the full id table is announced again, so that receivers started later (or which lost an announcement) can resolve ids"}, 30};
+		/// "fragment_size" (Default: 65507): Messages larger than this are split into fragments of at most this size
+		fhicl::Atom<size_t> fragment_size = fhicl::Atom<size_t>{
+		    fhicl::Name{"fragment_size"},
+		    fhicl::Comment{"Messages larger than this many bytes are split into numbered fragments of at most this size, which UDPReceiver reassembles. The default is the largest UDP datagram; lower it (e.g. to 1472) to avoid IP fragmentation"}, mfviewer::detail::MAX_UDP_PAYLOAD};
 	};
 	/// Used for ParameterSet validation
 	using Parameters = fhicl::WrappedTable<Config>;
@@ -80,19 +137,20 @@ public:
 	/// <param name="pset">ParameterSet used to configure ELUDP</param>
 	ELUDP(Parameters const& pset);
 
+	/// <summary>
+	/// ELUDP Destructor. In async mode, drains the send queue before closing the socket
+	/// </summary>
+	~ELUDP() override;
+
 	/**
-	 * \brief Fill the "Prefix" portion of the message
-	 * \param o Output stringstream
-	 * \param msg MessageFacility object containing header information
+	 * \brief Fill the "Prefix" portion of the message (Unused, the message is built in routePayload)
 	 */
-	void fillPrefix(std::ostringstream& o, const ErrorObj& msg) override;
+	void fillPrefix(std::ostringstream& /*unused*/, const ErrorObj& /*msg*/) override {}
 
 	/**
-	 * \brief Fill the "User Message" portion of the message
-	 * \param o Output stringstream
-	 * \param msg MessageFacility object containing header information
+	 * \brief Fill the "User Message" portion of the message (Unused, the message is built in routePayload)
 	 */
-	void fillUsrMsg(std::ostringstream& o, const ErrorObj& msg) override;
+	void fillUsrMsg(std::ostringstream& /*unused*/, const ErrorObj& /*msg*/) override {}
 
 	/**
 	 * \brief Fill the "Suffix" portion of the message (Unused)
@@ -107,7 +165,27 @@ public:
 	void routePayload(const std::ostringstream& o, const ErrorObj& e) override;
 
 private:
+	ELUDP(ELUDP const&) = delete;
+	ELUDP(ELUDP&&) = delete;
+	ELUDP& operator=(ELUDP const&) = delete;
+	ELUDP& operator=(ELUDP&&) = delete;
+
 	void reconnect_();
+	void format_text_(const ErrorObj& msg);
+	void encode_binary_(const ErrorObj& msg);
+	void route_dictionary_(const ErrorObj& msg);
+	bool intern_(std::string_view str, uint16_t& id);
+	void announce_dictionary_(std::vector<uint16_t> const& ids);
+	void dispatch_(std::string const& payload);
+	void transmit_(std::string const& payload);
+	void send_(std::string const& payload);
+	void send_batch_(std::deque<std::string> const& batch);
+	void pack_(std::deque<std::string> const& batch);
+	bool batch_ready_() const;
+	bool wait_writable_();
+	void record_send_status_(bool ok);
+	void enqueue_(std::string&& payload);
+	void sender_loop_();
 
 	// Parameters
 	int error_report_backoff_factor_;
@@ -124,13 +202,70 @@ private:
 	int consecutive_success_count_;
 	int error_count_;
 	int next_error_report_;
-	int seqNum_;
+	std::atomic<int> seqNum_;
 
 	int64_t pid_;
 	std::string hostname_;
 	std::string hostaddr_;
 	std::string app_;
 	std::string filename_delimit_;
+
+	// Formatting state, reused for every message so that building the datagram does not allocate. The timestamp and
+	// iteration strings from messagefacility, and the send queue's copy in async mode, still do.
+	// Everything from here to the dictionary is only touched with format_mutex_ held, as logging threads call
+	// routePayload concurrently.
+	std::mutex format_mutex_;
+	std::unique_ptr<detail::UDPTextFormatter> formatter_;
+	std::string body_;
+	std::string payload_;
+
+	enum class WireFormat
+	{
+		Text,
+		Binary,
+		Dictionary
+	};
+	WireFormat wire_format_;
+
+	// Identifies this process to receivers, for dictionary ids and fragment reassembly
+	uint64_t session_id_;
+
+	// Fragmentation of large messages
+	size_t fragment_size_;
+	uint32_t next_fragment_id_;
+	std::string fragment_;
+
+	// Dictionary mode
+	std::map<std::string, uint16_t, std::less<>> dictionary_ids_;
+	std::vector<std::string> dictionary_strings_;
+	std::vector<uint16_t> pending_ids_;
+	std::chrono::steady_clock::duration dictionary_refresh_;
+	std::chrono::steady_clock::time_point last_dictionary_announce_;
+
+	// Async send mode
+	bool async_send_;
+	size_t async_queue_size_;
+	int send_buffer_size_;
+	size_t batch_size_;
+	std::chrono::milliseconds batch_linger_;
+	bool pack_messages_;
+	size_t max_datagram_size_;
+
+	std::mutex queue_mutex_;
+	std::condition_variable queue_cv_;
+	std::deque<std::string> send_queue_;
+	size_t queued_bytes_;
+	std::thread sender_thread_;
+	std::atomic<bool> stop_sender_;
+	detail::WritableWaiter writable_;
+
+	std::atomic<size_t> queue_high_water_;
+	std::atomic<size_t> queue_dropped_;
+	size_t next_drop_report_;
+
+	std::deque<std::string> packed_;
+	std::vector<struct mmsghdr> mmsg_;
+	std::vector<struct iovec> iov_;
 };
 
 // END DECLARATION
@@ -142,7 +277,7 @@ private:
 //======================================================================
 
 ELUDP::ELUDP(Parameters const& pset)
-    : ELdestination(pset().elDestConfig()), error_report_backoff_factor_(pset().error_report()), error_max_(pset().error_max()), host_(pset().host()), port_(pset().port()), multicast_enabled_(pset().multicast_enabled()), multicast_out_addr_(pset().output_address()), message_socket_(-1), consecutive_success_count_(0), error_count_(0), next_error_report_(1), seqNum_(0), pid_(static_cast<int64_t>(getpid())), filename_delimit_(pset().filename_delimit())
+    : ELdestination(pset().elDestConfig()), error_report_backoff_factor_(pset().error_report()), error_max_(pset().error_max()), host_(pset().host()), port_(pset().port()), multicast_enabled_(pset().multicast_enabled()), multicast_out_addr_(pset().output_address()), message_socket_(-1), consecutive_success_count_(0), error_count_(0), next_error_report_(1), seqNum_(0), pid_(static_cast<int64_t>(getpid())), filename_delimit_(pset().filename_delimit()), wire_format_(WireFormat::Text), session_id_(0), fragment_size_(pset().fragment_size()), next_fragment_id_(0), dictionary_refresh_(std::chrono::seconds(pset().dictionary_refresh_s())), async_send_(pset().async_send()), async_queue_size_(pset().async_queue_size()), send_buffer_size_(pset().socket_send_buffer_size()), batch_size_(pset().batch_size()), batch_linger_(pset().batch_linger_ms()), pack_messages_(pset().pack_messages()), max_datagram_size_(pset().max_datagram_size()), queued_bytes_(0), stop_sender_(false), writable_(std::chrono::milliseconds(100), std::chrono::milliseconds(pset().drain_timeout_ms())), queue_high_water_(0), queue_dropped_(0), next_drop_report_(1)
 {
 	// hostname
 	char hostname_c[1024];
@@ -237,6 +372,81 @@ ELUDP::ELUDP(Parameters const& pset)
 
 	app_ = procinfo.substr(start + 1, end - start - 1);
 #endif
+
+	formatter_ = std::make_unique<detail::UDPTextFormatter>(hostname_, hostaddr_, app_, pid_, filename_delimit_);
+
+	// Receivers key dictionaries and fragments on this, so it must not repeat across processes or restarts
+	std::random_device rd;
+	session_id_ = (static_cast<uint64_t>(rd()) << 32) ^ rd() ^ static_cast<uint64_t>(pid_) ^
+	              static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+
+	if (fragment_size_ <= mfviewer::detail::FRAGMENT_HEADER_SIZE) fragment_size_ = mfviewer::detail::FRAGMENT_HEADER_SIZE + 1;
+	if (fragment_size_ > mfviewer::detail::MAX_UDP_PAYLOAD) fragment_size_ = mfviewer::detail::MAX_UDP_PAYLOAD;
+
+	auto wire_format = pset().wire_format();
+	if (wire_format == "binary")
+	{
+		wire_format_ = WireFormat::Binary;
+	}
+	else if (wire_format == "dictionary")
+	{
+		wire_format_ = WireFormat::Dictionary;
+
+		// The constant fields get the first ids (0, 1 and 2), and go out with the first message
+		uint16_t id;
+		intern_(hostname_, id);
+		intern_(hostaddr_, id);
+		intern_(app_, id);
+		last_dictionary_announce_ = std::chrono::steady_clock::now();
+	}
+	else if (wire_format != "text")
+	{
+		TLOG(TLVL_WARNING) << "Unknown wire_format \"" << wire_format << "\", using \"text\"";
+	}
+
+	if (batch_size_ == 0) batch_size_ = 1;
+	if (batch_size_ > IOV_MAX) batch_size_ = IOV_MAX;  // sendmmsg sends at most UIO_MAXIOV (== IOV_MAX) messages per call
+	if (batch_size_ > 1)
+	{
+		// Batches are collected and flushed by the sender thread
+		async_send_ = true;
+		mmsg_.resize(batch_size_);
+		iov_.resize(batch_size_);
+	}
+	if (pack_messages_)
+	{
+		async_send_ = true;
+		if (max_datagram_size_ > mfviewer::detail::MAX_UDP_PAYLOAD) max_datagram_size_ = mfviewer::detail::MAX_UDP_PAYLOAD;
+	}
+
+	if (async_send_)
+	{
+		if (async_queue_size_ == 0) async_queue_size_ = 1;
+		sender_thread_ = std::thread([this] { sender_loop_(); });
+	}
+}
+
+ELUDP::~ELUDP()
+{
+	if (sender_thread_.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lk(queue_mutex_);
+			writable_.start_drain();
+			stop_sender_ = true;
+		}
+		queue_cv_.notify_all();
+		sender_thread_.join();
+
+		TLOG(TLVL_DEBUG + 32) << "Async sender stopped, queue high water mark=" << queue_high_water_.load()
+		                      << ", messages dropped on full queue=" << queue_dropped_.load();
+	}
+
+	if (message_socket_ != -1)
+	{
+		close(message_socket_);
+		message_socket_ = -1;
+	}
 }
 
 void ELUDP::reconnect_()
@@ -302,117 +512,414 @@ void ELUDP::reconnect_()
 			TLOG(TLVL_ERROR) << "Cannot set message socket to broadcast, err=" << strerror(errno);
 			exit(1);
 		}
+		if (send_buffer_size_ > 0)
+		{
+			int len = send_buffer_size_;
+			if (setsockopt(message_socket_, SOL_SOCKET, SO_SNDBUF, &len, sizeof(len)) < 0)
+			{
+				TLOG(TLVL_WARNING) << "Unable to set send buffer size to " << send_buffer_size_ << ", err=" << strerror(errno);
+			}
+		}
+		if (async_send_)
+		{
+			int flags = fcntl(message_socket_, F_GETFL, 0);
+			if (flags == -1 || fcntl(message_socket_, F_SETFL, flags | O_NONBLOCK) == -1)
+			{
+				TLOG(TLVL_ERROR) << "Unable to make message socket non-blocking, err=" << strerror(errno);
+				exit(1);
+			}
+		}
 	}
 }
 
 //======================================================================
-// Message prefix filler ( overriddes ELdestination::fillPrefix )
+// Message router ( overriddes ELdestination::routePayload )
 //======================================================================
-void ELUDP::fillPrefix(std::ostringstream& oss, const ErrorObj& msg)
+void ELUDP::routePayload(const std::ostringstream& /*oss*/, const ErrorObj& msg)
+{
+	// The message is built in payload_ rather than the stream, whose contents could only be extracted by copying.
+	// The scratch buffers, fragment ids and dictionary are shared by all logging threads, so the whole message is
+	// built and dispatched under one lock.
+	std::lock_guard<std::mutex> lk(format_mutex_);
+
+	body_.clear();
+	detail::UDPTextFormatter::append_body(body_, msg.items());
+
+	switch (wire_format_)
+	{
+		case WireFormat::Binary:
+			encode_binary_(msg);
+			dispatch_(payload_);
+			break;
+		case WireFormat::Dictionary:
+			route_dictionary_(msg);
+			break;
+		default:
+			format_text_(msg);
+			payload_.append(body_);
+			dispatch_(payload_);
+			break;
+	}
+}
+
+void ELUDP::format_text_(const ErrorObj& msg)
 {
 	const auto& xid = msg.xid();
+	formatter_->format_prefix(payload_, format_.timestamp(msg.timestamp()), ++seqNum_, xid.severity().getName(), xid.id(),
+	                          mf::GetIteration(), xid.module(), msg.filename(), msg.lineNumber());
+}
 
-	auto id = xid.id();
-	auto module = xid.module();
-	auto app = app_;
-	std::replace(id.begin(), id.end(), '|', '!');
-	std::replace(app.begin(), app.end(), '|', '!');
-	std::replace(module.begin(), module.end(), '|', '!');
-
-	oss << format_.timestamp(msg.timestamp()) << "|";  // timestamp
-	oss << std::to_string(++seqNum_) << "|";           // sequence number
-	oss << hostname_ << "|";                           // host name
-	oss << hostaddr_ << "|";                           // host address
-	oss << xid.severity().getName() << "|";            // severity
-	oss << id << "|";                                  // category
-	oss << app << "|";                                 // application
-	oss << pid_ << "|";
-	oss << mf::GetIteration() << "|";  // run/event no
-
-	oss << module << "|";  // module name
-	if (filename_delimit_.empty())
-	{
-		oss << msg.filename();
+void ELUDP::dispatch_(std::string const& payload)
+{
+	if (payload.size() <= fragment_size_)
+	{
+		transmit_(payload);
+		return;
 	}
-	else if (filename_delimit_.size() == 1)  // for a single character (i.e '/'), search in reverse.
+
+	auto ok = mfviewer::detail::split_fragments(payload, session_id_, next_fragment_id_++, fragment_size_, fragment_,
+	                                            [this](std::string const& fragment) { transmit_(fragment); });
+	if (!ok)
 	{
-		oss << (strrchr(&msg.filename()[0], filename_delimit_[0]) != nullptr  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-		            ? strrchr(&msg.filename()[0], filename_delimit_[0]) + 1   // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-		            : msg.filename());
+		TLOG(TLVL_WARNING) << "Dropping message of " << payload.size() << " bytes, too large to send even in fragments";
 	}
-	else
+}
+
+void ELUDP::transmit_(std::string const& payload)
+{
+	if (async_send_)
+	{
+		// The queue needs its own copy; payload_ keeps its capacity for the next message
+		enqueue_(std::string(payload));
+		return;
+	}
+
+	if (message_socket_ == -1)
+	{
+		reconnect_();
+	}
+	send_(payload);
+}
+
+void ELUDP::encode_binary_(const ErrorObj& msg)
+{
+	const auto& xid = msg.xid();
+	auto iteration = mf::GetIteration();
+	auto tv = msg.timestamp();
+
+	mfviewer::detail::BinaryRecord rec;
+	rec.severity = static_cast<uint8_t>(xid.severity().getLevel());
+	rec.timestamp_us = static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+	rec.seqNum = ++seqNum_;
+	rec.pid = static_cast<uint32_t>(pid_);
+	rec.line = msg.lineNumber();
+	rec.hostname = hostname_;
+	rec.hostaddr = hostaddr_;
+	rec.category = xid.id();
+	rec.application = app_;
+	rec.iteration = iteration;
+	rec.module = xid.module();
+	rec.file = formatter_->trim_filename(msg.filename());
+	rec.message = body_;
+
+	payload_.clear();
+	mfviewer::detail::append_binary_record(payload_, rec);
+}
+
+void ELUDP::route_dictionary_(const ErrorObj& msg)
+{
+	const auto& xid = msg.xid();
+
+	mfviewer::detail::DictionaryRecord rec;
+	rec.hostname = 0;
+	rec.hostaddr = 1;
+	rec.application = 2;
+	if (!intern_(xid.id(), rec.category) || !intern_(xid.module(), rec.module) ||
+	    !intern_(formatter_->trim_filename(msg.filename()), rec.file))
+	{
+		// The id space is exhausted; this message has to carry its own strings
+		pending_ids_.clear();
+		encode_binary_(msg);
+		dispatch_(payload_);
+		return;
+	}
+
+	// Announcements travel through the same queue as messages, so they arrive first unless the network drops them.
+	// The periodic full announcement lets receivers recover from that, or from starting after us.
+	auto now = std::chrono::steady_clock::now();
+	if (now - last_dictionary_announce_ >= dictionary_refresh_)
 	{
-		const char* cp = strstr(&msg.filename()[0], &filename_delimit_[0]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-		if (cp != nullptr)
+		pending_ids_.resize(dictionary_strings_.size());
+		for (size_t ii = 0; ii < pending_ids_.size(); ++ii) pending_ids_[ii] = static_cast<uint16_t>(ii);
+		last_dictionary_announce_ = now;
+	}
+	if (!pending_ids_.empty())
+	{
+		announce_dictionary_(pending_ids_);
+		pending_ids_.clear();
+	}
+
+	auto iteration = mf::GetIteration();
+	auto tv = msg.timestamp();
+
+	rec.severity = static_cast<uint8_t>(xid.severity().getLevel());
+	rec.session = session_id_;
+	rec.timestamp_us = static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+	rec.seqNum = ++seqNum_;
+	rec.line = msg.lineNumber();
+	rec.iteration = iteration;
+	rec.message = body_;
+
+	payload_.clear();
+	mfviewer::detail::append_dictionary_record(payload_, rec);
+	dispatch_(payload_);
+}
+
+bool ELUDP::intern_(std::string_view str, uint16_t& id)
+{
+	auto it = dictionary_ids_.find(str);
+	if (it != dictionary_ids_.end())
+	{
+		id = it->second;
+		return true;
+	}
+	if (dictionary_strings_.size() > UINT16_MAX) return false;
+
+	id = static_cast<uint16_t>(dictionary_strings_.size());
+	dictionary_strings_.emplace_back(str);
+	dictionary_ids_.emplace(dictionary_strings_.back(), id);
+	pending_ids_.push_back(id);
+	return true;
+}
+
+void ELUDP::announce_dictionary_(std::vector<uint16_t> const& ids)
+{
+	auto const max_size = pack_messages_ ? max_datagram_size_ : mfviewer::detail::MAX_UDP_PAYLOAD;
+
+	std::string announcement;
+	for (auto id : ids)
+	{
+		auto const& str = dictionary_strings_[id];
+		if (!announcement.empty() && mfviewer::detail::append_dictionary_entry(announcement, id, str, max_size)) continue;
+
+		if (!announcement.empty()) dispatch_(announcement);
+		mfviewer::detail::begin_dictionary(announcement, session_id_, static_cast<uint32_t>(pid_));
+		// An entry too large for max_size still goes out, alone, in a datagram of its own
+		mfviewer::detail::append_dictionary_entry(announcement, id, str, mfviewer::detail::MAX_UDP_PAYLOAD);
+	}
+	if (!announcement.empty()) dispatch_(announcement);
+}
+
+void ELUDP::send_(std::string const& payload)
+{
+	if (error_count_ < error_max_ || error_max_ == 0)
+	{
+		auto sts = sendto(message_socket_, payload.c_str(), payload.size(), 0, reinterpret_cast<struct sockaddr*>(&message_addr_),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		                  sizeof(message_addr_));
+
+		while (sts < 0 && wait_writable_())
 		{
-			// make sure to remove a part that ends with '/'
-			cp += filename_delimit_.size() - 1;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			while (*cp && *cp != '/') ++cp;
-			++cp;  // increment past '/'
-			oss << cp;
+			sts = sendto(message_socket_, payload.c_str(), payload.size(), 0, reinterpret_cast<struct sockaddr*>(&message_addr_),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+			             sizeof(message_addr_));
 		}
-		else
-			oss << msg.filename();
+
+		record_send_status_(sts >= 0);
 	}
-	oss << "|" << std::to_string(msg.lineNumber()) << "|";
 }
 
-//======================================================================
-// Message filler ( overriddes ELdestination::fillUsrMsg )
-//======================================================================
-void ELUDP::fillUsrMsg(std::ostringstream& oss, const ErrorObj& msg)
+void ELUDP::send_batch_(std::deque<std::string> const& batch)
 {
-	std::ostringstream tmposs;
-	// Print the contents.
-	for (auto const& val : msg.items())
+	auto it = batch.begin();
+	while (it != batch.end())
 	{
-		tmposs << val;
+		if (error_count_ >= error_max_ && error_max_ != 0) return;
+
+		unsigned int count = 0;
+		for (; it != batch.end() && count < batch_size_; ++it, ++count)
+		{
+			iov_[count].iov_base = const_cast<char*>(it->data());  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+			iov_[count].iov_len = it->size();
+			memset(&mmsg_[count], 0, sizeof(mmsg_[count]));
+			mmsg_[count].msg_hdr.msg_name = &message_addr_;
+			mmsg_[count].msg_hdr.msg_namelen = sizeof(message_addr_);
+			mmsg_[count].msg_hdr.msg_iov = &iov_[count];
+			mmsg_[count].msg_hdr.msg_iovlen = 1;
+		}
+
+		unsigned int sent = 0;
+		while (sent < count)
+		{
+			auto sts = sendmmsg(message_socket_, &mmsg_[sent], count - sent, 0);
+			if (sts < 0)
+			{
+				if (wait_writable_()) continue;
+
+				// Skip the datagram that failed and carry on with the rest of the batch
+				record_send_status_(false);
+				++sent;
+			}
+			else
+			{
+				for (int ii = 0; ii < sts; ++ii) record_send_status_(true);
+				sent += sts;
+			}
+		}
 	}
+}
 
-	// remove leading "\n" if present
-	const std::string& usrMsg = tmposs.str().compare(0, 1, "\n") == 0 ? tmposs.str().erase(0, 1) : tmposs.str();
+bool ELUDP::wait_writable_()
+{
+	// In async mode the socket is non-blocking; wait for room in the socket buffer on the sender thread instead.
+	// While draining the queue at shutdown, the waits share drain_timeout_ms rather than being bounded one by one.
+	if (!async_send_ || (errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+	return writable_.wait(message_socket_);
+}
 
-	oss << usrMsg;
+void ELUDP::record_send_status_(bool ok)
+{
+	if (!ok)
+	{
+		consecutive_success_count_ = 0;
+		++error_count_;
+		if (error_count_ == next_error_report_)
+		{
+			TLOG(TLVL_ERROR) << "Error sending message " << seqNum_ << " to " << host_ << ", errno=" << errno << " ("
+			                 << strerror(errno) << ")";
+			next_error_report_ *= error_report_backoff_factor_;
+		}
+	}
+	else
+	{
+		++consecutive_success_count_;
+		if (consecutive_success_count_ >= 5)
+		{
+			error_count_ = 0;
+			next_error_report_ = 1;
+		}
+	}
 }
 
-//======================================================================
-// Message router ( overriddes ELdestination::routePayload )
-//======================================================================
-void ELUDP::routePayload(const std::ostringstream& oss, const ErrorObj& /*msg*/)
+void ELUDP::enqueue_(std::string&& payload)
 {
-	if (message_socket_ == -1)
+	size_t dropped = 0;
+	bool report = false;
+	bool wake = false;
 	{
-		reconnect_();
+		std::lock_guard<std::mutex> lk(queue_mutex_);
+		if (send_queue_.size() >= async_queue_size_)
+		{
+			dropped = ++queue_dropped_;
+			if (dropped == next_drop_report_)
+			{
+				report = true;
+				next_drop_report_ *= error_report_backoff_factor_ > 1 ? error_report_backoff_factor_ : 2;
+			}
+		}
+		else
+		{
+			queued_bytes_ += payload.size();
+			send_queue_.push_back(std::move(payload));
+			if (send_queue_.size() > queue_high_water_) queue_high_water_ = send_queue_.size();
+
+			// The sender thread only needs waking when work appears, or when a lingering batch fills up
+			wake = send_queue_.size() == 1 || batch_ready_();
+		}
 	}
-	if (error_count_ < error_max_ || error_max_ == 0)
+
+	if (wake)
+	{
+		queue_cv_.notify_one();
+	}
+	else if (report)
 	{
-		char str[INET_ADDRSTRLEN];
-		inet_ntop(AF_INET, &(message_addr_.sin_addr), str, INET_ADDRSTRLEN);
+		TLOG(TLVL_WARNING) << "Async send queue full (" << async_queue_size_ << " messages), " << dropped
+		                   << " messages dropped so far";
+	}
+}
 
-		auto string = "UDPMFMESSAGE" + std::to_string(pid_) + "|" + oss.str();
-		auto sts = sendto(message_socket_, string.c_str(), string.size(), 0, reinterpret_cast<struct sockaddr*>(&message_addr_),  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
-		                  sizeof(message_addr_));
+bool ELUDP::batch_ready_() const
+{
+	if (pack_messages_) return queued_bytes_ >= max_datagram_size_ * batch_size_;
+	return batch_size_ > 1 && send_queue_.size() >= batch_size_;
+}
 
-		if (sts < 0)
+void ELUDP::pack_(std::deque<std::string> const& batch)
+{
+	std::string frame;
+	std::string const* first = nullptr;
+
+	// A frame holding a single record is sent as that record alone, saving the framing overhead
+	auto flush = [&] {
+		if (first == nullptr) return;
+		if (mfviewer::detail::frame_record_count(frame) == 1)
+			packed_.push_back(*first);
+		else
+			packed_.push_back(std::move(frame));
+		first = nullptr;
+	};
+
+	for (auto const& payload : batch)
+	{
+		if (mfviewer::detail::FRAMED_HEADER_SIZE + mfviewer::detail::FRAMED_RECORD_HEADER_SIZE + payload.size() > max_datagram_size_)
+		{
+			// Too large to share a datagram with anything; send it on its own
+			packed_.push_back(payload);
+			continue;
+		}
+
+		if (first != nullptr && !mfviewer::detail::append_record(frame, payload.data(), payload.size(), max_datagram_size_))
+		{
+			flush();
+		}
+		if (first == nullptr)
+		{
+			mfviewer::detail::begin_frame(frame);
+			mfviewer::detail::append_record(frame, payload.data(), payload.size(), max_datagram_size_);
+			first = &payload;
+		}
+	}
+	flush();
+}
+
+void ELUDP::sender_loop_()
+{
+	reconnect_();
+
+	std::deque<std::string> batch;
+	while (true)
+	{
 		{
-			consecutive_success_count_ = 0;
-			++error_count_;
-			if (error_count_ == next_error_report_)
+			std::unique_lock<std::mutex> lk(queue_mutex_);
+			queue_cv_.wait(lk, [this] { return stop_sender_ || !send_queue_.empty(); });
+			if (send_queue_.empty() && stop_sender_) break;
+
+			if ((batch_size_ > 1 || pack_messages_) && batch_linger_.count() > 0 && !batch_ready_())
 			{
-				TLOG(TLVL_ERROR) << "Error sending message " << seqNum_ << " to " << host_ << ", errno=" << errno << " ("
-				                 << strerror(errno) << ")";
-				next_error_report_ *= error_report_backoff_factor_;
+				queue_cv_.wait_for(lk, batch_linger_, [this] { return stop_sender_ || batch_ready_(); });
 			}
+			batch.swap(send_queue_);
+			queued_bytes_ = 0;
+		}
+
+		if (pack_messages_)
+		{
+			pack_(batch);
+			batch.swap(packed_);
+			packed_.clear();
+		}
+
+		if (batch_size_ > 1)
+		{
+			send_batch_(batch);
 		}
 		else
 		{
-			++consecutive_success_count_;
-			if (consecutive_success_count_ >= 5)
+			for (auto const& payload : batch)
 			{
-				error_count_ = 0;
-				next_error_report_ = 1;
+				send_(payload);
 			}
 		}
+		batch.clear();
 	}
 }
 }  // end namespace mfplugins
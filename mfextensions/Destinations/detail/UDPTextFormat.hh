@@ -0,0 +1,183 @@
+#ifndef mfextensions_Destinations_detail_UDPTextFormat_hh
+#define mfextensions_Destinations_detail_UDPTextFormat_hh
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace mfplugins {
+namespace detail {
+
+/// <summary>
+/// Builds the pipe-delimited "UDPMFMESSAGE" text datagrams sent by ELUDP.
+///
+/// The fields that never change for a process (host name, address, application and PID) are escaped and
+/// concatenated once, trimmed file names are cached, and everything is appended to a caller-owned buffer,
+/// so that formatting a message does not allocate once the buffer has grown to its working size. The fields passed
+/// in (the timestamp and iteration strings in ELUDP) are the caller's to provide.
+/// </summary>
+class UDPTextFormatter
+{
+public:
+	/// Field separator of the text format
+	static constexpr char DELIMITER = '|';
+	/// Replacement for DELIMITER characters appearing inside a field
+	static constexpr char ESCAPE = '!';
+	/// Number of distinct file names remembered by trim_filename before the cache is reset
+	static constexpr size_t MAX_CACHED_FILENAMES = 4096;
+
+	/**
+	 * \brief UDPTextFormatter Constructor
+	 * \param hostname Host name of this process
+	 * \param hostaddr Host address of this process
+	 * \param app Application name of this process
+	 * \param pid Process ID
+	 * \param filename_delimit File names are trimmed to the part after this (see ELUDP "filename_delimit")
+	 */
+	UDPTextFormatter(std::string_view hostname, std::string_view hostaddr, std::string_view app, int64_t pid,
+	                 std::string filename_delimit)
+	    : filename_delimit_(std::move(filename_delimit))
+	{
+		header_ = "UDPMFMESSAGE";
+		append_int(header_, pid);
+		header_ += DELIMITER;
+
+		host_fields_.append(hostname);
+		host_fields_ += DELIMITER;
+		host_fields_.append(hostaddr);
+		host_fields_ += DELIMITER;
+
+		append_escaped(app_fields_, app);
+		app_fields_ += DELIMITER;
+		append_int(app_fields_, pid);
+		app_fields_ += DELIMITER;
+	}
+
+	/**
+	 * \brief Start a new datagram in out (previous contents are discarded, capacity is kept) and append the
+	 * header fields of a message
+	 * \param out Buffer to hold the datagram
+	 * \param timestamp Formatted message time
+	 * \param seqNum Message sequence number
+	 * \param severity Severity name
+	 * \param category Message category
+	 * \param iteration Run/event number
+	 * \param module Module name
+	 * \param filename Untrimmed source file name
+	 * \param line Source line number
+	 */
+	void format_prefix(std::string& out, std::string_view timestamp, int seqNum, std::string_view severity,
+	                   std::string_view category, std::string_view iteration, std::string_view module,
+	                   std::string const& filename, int line)
+	{
+		out.assign(header_);
+		out.append(timestamp);
+		out += DELIMITER;
+		append_int(out, seqNum);
+		out += DELIMITER;
+		out.append(host_fields_);
+		out.append(severity);
+		out += DELIMITER;
+		append_escaped(out, category);
+		out += DELIMITER;
+		out.append(app_fields_);
+		out.append(iteration);
+		out += DELIMITER;
+		append_escaped(out, module);
+		out += DELIMITER;
+		out.append(trim_filename(filename));
+		out += DELIMITER;
+		append_int(out, line);
+		out += DELIMITER;
+	}
+
+	/**
+	 * \brief Append the pieces of a message body, dropping a single leading newline
+	 * \param out Buffer to append to
+	 * \param items Sequence of strings making up the message body
+	 */
+	template<typename Items>
+	static void append_body(std::string& out, Items const& items)
+	{
+		bool leading = true;
+		for (auto const& item : items)
+		{
+			std::string_view sv(item);
+			if (leading && !sv.empty())
+			{
+				if (sv.front() == '\n') sv.remove_prefix(1);
+				leading = false;
+			}
+			out.append(sv);
+		}
+	}
+
+	/**
+	 * \brief Strip the leading part of a file name, as configured by filename_delimit
+	 * \param filename File name to trim
+	 * \return View of the trimmed file name, pointing into filename
+	 */
+	std::string_view trim_filename(std::string const& filename)
+	{
+		// A single-character delimiter is one reverse scan, which is as cheap as a cache lookup
+		if (filename_delimit_.size() < 2) return std::string_view(filename).substr(trim_offset(filename));
+
+		auto it = trim_cache_.find(filename);
+		if (it == trim_cache_.end())
+		{
+			if (trim_cache_.size() >= MAX_CACHED_FILENAMES) trim_cache_.clear();
+			it = trim_cache_.emplace(filename, trim_offset(filename)).first;
+		}
+		return std::string_view(filename).substr(it->second);
+	}
+
+private:
+	size_t trim_offset(std::string const& filename) const
+	{
+		if (filename_delimit_.empty()) return 0;
+		if (filename_delimit_.size() == 1)  // for a single character (i.e '/'), search in reverse.
+		{
+			auto pos = filename.rfind(filename_delimit_[0]);
+			return pos != std::string::npos ? pos + 1 : 0;
+		}
+
+		auto pos = filename.find(filename_delimit_);
+		if (pos == std::string::npos) return 0;
+
+		// make sure to remove a part that ends with '/'
+		pos = filename.find('/', pos + filename_delimit_.size() - 1);
+		return pos != std::string::npos ? pos + 1 : filename.size();
+	}
+
+	static void append_escaped(std::string& out, std::string_view field)
+	{
+		auto start = out.size();
+		out.append(field);
+		for (auto ii = start; ii < out.size(); ++ii)
+		{
+			if (out[ii] == DELIMITER) out[ii] = ESCAPE;
+		}
+	}
+
+	template<typename T>
+	static void append_int(std::string& out, T value)
+	{
+		char buf[24];
+		auto res = std::to_chars(buf, buf + sizeof(buf), value);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		out.append(buf, res.ptr);
+	}
+
+	std::string filename_delimit_;
+	std::string header_;
+	std::string host_fields_;
+	std::string app_fields_;
+	std::unordered_map<std::string, size_t> trim_cache_;
+};
+
+}  // namespace detail
+}  // namespace mfplugins
+
+#endif  // mfextensions_Destinations_detail_UDPTextFormat_hh
@@ -0,0 +1,81 @@
+#ifndef mfextensions_Destinations_detail_WritableWaiter_hh
+#define mfextensions_Destinations_detail_WritableWaiter_hh
+
+#include <poll.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+
+namespace mfplugins {
+namespace detail {
+
+/// <summary>
+/// Waits for room in the send buffer of a non-blocking socket, after a send failed with EAGAIN.
+///
+/// While sending normally, each wait is bounded on its own, so that a stalled network costs at most one timeout per
+/// message. Once start_drain() has been called (when the destination is being destroyed and its queue flushed), all
+/// waits share a single deadline instead: messages meeting a full buffer are retried until it passes, and the whole
+/// drain still ends in bounded time however many messages are left.
+/// </summary>
+class WritableWaiter
+{
+public:
+	/**
+	 * \brief WritableWaiter Constructor
+	 * \param wait_timeout Limit on each wait while sending normally
+	 * \param drain_timeout Limit on all waits together once start_drain() has been called
+	 */
+	WritableWaiter(std::chrono::milliseconds wait_timeout, std::chrono::milliseconds drain_timeout)
+	    : wait_timeout_(wait_timeout)
+	    , drain_timeout_(drain_timeout)
+	    , drain_deadline_(0)
+	{}
+
+	/// Start the shutdown drain; waits from now on share drain_timeout. May be called from any thread.
+	void start_drain()
+	{
+		auto deadline = std::chrono::steady_clock::now() + drain_timeout_;
+		drain_deadline_.store(deadline.time_since_epoch().count(), std::memory_order_release);
+	}
+
+	/// Whether start_drain() has been called
+	bool draining() const { return drain_deadline_.load(std::memory_order_acquire) != 0; }
+
+	/**
+	 * \brief Wait until the socket can be written to
+	 * \param fd Non-blocking socket whose last send failed
+	 * \return True if the send should be retried; false (with errno set to EAGAIN) if the wait timed out or the
+	 *         drain deadline has passed
+	 */
+	bool wait(int fd) const
+	{
+		auto timeout = wait_timeout_;
+		auto deadline = drain_deadline_.load(std::memory_order_acquire);
+		if (deadline != 0)
+		{
+			auto left = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(deadline)) - std::chrono::steady_clock::now();
+			timeout = std::chrono::ceil<std::chrono::milliseconds>(left);
+		}
+
+		struct pollfd ufds[1];
+		ufds[0].fd = fd;
+		ufds[0].events = POLLOUT;
+		if (timeout.count() <= 0 || poll(ufds, 1, static_cast<int>(timeout.count())) <= 0)  // NOLINT(cppcoreguidelines-pro-bounds-array-to-pointer-decay)
+		{
+			errno = EAGAIN;
+			return false;
+		}
+		return true;
+	}
+
+private:
+	std::chrono::milliseconds wait_timeout_;
+	std::chrono::milliseconds drain_timeout_;
+	std::atomic<int64_t> drain_deadline_;  // steady_clock ticks, 0 until start_drain()
+};
+
+}  // namespace detail
+}  // namespace mfplugins
+
+#endif  // mfextensions_Destinations_detail_WritableWaiter_hh
@@ -8,11 +8,12 @@ mfviewer::LogReader::LogReader(const fhicl::ParameterSet& pset)
 //  ( "([^\\s]*)\\s([^\\s]*)\\s([^\\s]*)\\s(([^\\s]*)\\s)?([^:]*):(\\d*)" )
 {
 	std::cout << "LogReader_receiver Constructor" << std::endl;
-	this->setObjectName("viewer Log");
 }
 
 mfviewer::LogReader::~LogReader()
 {
+	stop();
+	wait();
 	try
 	{
 		log_.close();
@@ -53,7 +54,7 @@ void mfviewer::LogReader::run()
 			if (msgFound)
 			{
 				std::cout << "Message found, emitting!" << std::endl;
-				emit NewMessage(read_next());
+				queueMessage(read_next());
 				++counter_;
 			}
 			log_.clear();
@@ -62,6 +63,7 @@ void mfviewer::LogReader::run()
 
 		log_.clear();
 		log_.close();
+		flushMessages(true);
 		usleep(500000);
 		// sleep(1);
 	}
@@ -72,7 +74,7 @@ void mfviewer::LogReader::run()
 #include <ctime>
 #include <iostream>
 
-msg_ptr_t mfviewer::LogReader::read_next()
+mf_msg_ptr_t mfviewer::LogReader::read_next()
 {
 	std::string line;
 
@@ -113,16 +115,7 @@ msg_ptr_t mfviewer::LogReader::read_next()
 				break;
 		}
 
-		struct tm tm;
-		time_t t;
-
-		value = std::string(what_[4].first, what_[4].second);
-		strptime(value.c_str(), "%d-%b-%Y %H:%M:%S", &tm);
-
-		tm.tm_isdst = -1;
-		t = mktime(&tm);
-		tv.tv_sec = t;
-		tv.tv_usec = 0;
+		timestamps_.decode(std::string_view(&*what_[4].first, what_[4].length()), tv);
 
 		category = std::string(what_[2].first, what_[2].second);
 		application = std::string(what_[3].first, what_[3].second);
@@ -134,9 +127,12 @@ msg_ptr_t mfviewer::LogReader::read_next()
 	std::string body;
 	getline(log_, line);
 
-	msg_ptr_t msg = std::make_shared<qt_mf_msg>("", category, application, 0, tv);
-	msg->setSeverityLevel(sev);
-	msg->setEventID(eventID);
+	auto msg = mf_msg::create();
+	msg->category = category;
+	msg->application = application;
+	msg->time = tv;
+	msg->sev = sev;
+	msg->eventID = eventID;
 
 	while (!log_.eof() && line.find("%MSG") == std::string::npos)
 	{
@@ -144,12 +140,11 @@ msg_ptr_t mfviewer::LogReader::read_next()
 		getline(log_, line);
 	}
 
-	msg->setMessage(filename_, counter_, body);
-	msg->updateText();
+	msg->sourceType = filename_;
+	msg->sourceSequence = counter_;
+	msg->message = body;
 
 	return msg;
 }
 
-#include "moc_LogReader_receiver.cpp"
-
 DEFINE_MFVIEWER_RECEIVER(mfviewer::LogReader)
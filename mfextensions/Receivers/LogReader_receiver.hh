@@ -10,6 +10,7 @@
 #include <boost/regex.hpp>
 
 #include "mfextensions/Receivers/MVReceiver.hh"
+#include "mfextensions/Receivers/detail/TimestampDecoder.hh"
 
 namespace mfviewer {
 /// <summary>
@@ -19,7 +20,6 @@ namespace mfviewer {
 /// </summary>
 class LogReader : public MVReceiver
 {
-	Q_OBJECT
 public:
 	/// <summary>
 	/// LogReader Constructor
@@ -33,15 +33,15 @@ public:
 	virtual ~LogReader();
 
 	/// <summary>
-	/// Receiver loop method. Reads messages from file and emits newMessage signal
+	/// Receiver loop method. Reads messages from file and queues them
 	/// </summary>
-	void run();
+	void run() override;
 
 	/// <summary>
 	/// Read the next message from the input stream
 	/// </summary>
-	/// <returns>qt_mf_msg from log file</returns>
-	msg_ptr_t read_next();  // read next log
+	/// <returns>mf_msg from log file</returns>
+	mf_msg_ptr_t read_next();  // read next log
 
 	/**
 	 * @brief Determine if the LogReader has reached the end of file
@@ -64,6 +64,7 @@ private:
 	boost::regex metadata_1;
 	// boost::regex  metadata_2;
 	boost::smatch what_;
+	detail::TimestampDecoder timestamps_;
 };
 }  // namespace mfviewer
 
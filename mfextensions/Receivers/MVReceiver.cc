@@ -1,7 +1,125 @@
 #include "MVReceiver.hh"
-#include "moc_MVReceiver.cpp"
-mfviewer::MVReceiver::MVReceiver(fhicl::ParameterSet const& /*pset*/)
+#include <algorithm>
+mfviewer::MVReceiver::MVReceiver(fhicl::ParameterSet const& pset)
     : stopRequested_(false)
+    , batch_size_(std::max(size_t{1}, pset.get<size_t>("batch_size", 256)))
+    , batch_latency_(std::chrono::milliseconds(pset.get<int>("batch_latency_ms", 5)))
+    , block_on_overflow_(pset.get<std::string>("overflow_policy", "shed") == "block")
+    , max_pending_(std::max(size_t{1}, pset.get<size_t>("max_pending_messages", 100000)))
+    , shed_max_severity_(std::min(SWARNING, mf_msg::severity_code(mf::ELseverityLevel(pset.get<std::string>("shed_max_severity", "INFO")))))
+    , shed_by_severity_()
+    , queue_(pset.get<size_t>("queue_size", 1024))
 {
 	std::cout << "MVReceiver Constructor" << std::endl;
+	batch_.reserve(batch_size_);
+}
+
+mfviewer::MVReceiver::~MVReceiver()
+{
+	stop();
+	wait();
+}
+
+void mfviewer::MVReceiver::start()
+{
+	stopRequested_ = false;
+	thread_ = std::thread([this] { run(); });
+}
+
+void mfviewer::MVReceiver::wait()
+{
+	if (thread_.joinable()) thread_.join();
+}
+
+void mfviewer::MVReceiver::queueMessage(mf_msg_ptr_t msg)
+{
+	{
+		std::lock_guard<std::mutex> lk(batch_mutex_);
+		if (batch_.empty()) batch_start_ = std::chrono::steady_clock::now();
+		batch_.push_back(std::move(msg));
+		if (batch_.size() < batch_size_ || !push_batch_()) return;
+	}
+	if (notify_) notify_();
+}
+
+void mfviewer::MVReceiver::flushMessages(bool force)
+{
+	{
+		std::lock_guard<std::mutex> lk(batch_mutex_);
+		if (batch_.empty() || (!force && std::chrono::steady_clock::now() - batch_start_ < batch_latency_)) return;
+		if (!push_batch_()) return;
+	}
+	if (notify_) notify_();
+}
+
+bool mfviewer::MVReceiver::push_batch_()
+{
+	while (!queue_.try_push(batch_))
+	{
+		if (stopRequested_)
+		{
+			batch_.clear();
+			return false;
+		}
+		if (!block_on_overflow_)
+		{
+			// Keep collecting; once too many are waiting, make room by dropping low-severity messages
+			if (batch_.size() <= max_pending_) return false;
+			shed_();
+			if (batch_.size() <= max_pending_) return false;
+		}
+		// Only messages which must not be dropped are left: wait for the consumer rather than lose them
+		if (notify_) notify_();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	batch_.clear();  // moved-from
+	batch_.reserve(batch_size_);
+	return true;
+}
+
+void mfviewer::MVReceiver::shed_()
+{
+	// Shed down to 90% of the limit, so that this does not run again for every message
+	auto to_drop = batch_.size() - max_pending_ * 9 / 10;
+
+	std::lock_guard<std::mutex> lk(shed_mutex_);
+	for (int sev = SDEBUG; sev <= shed_max_severity_ && to_drop > 0; ++sev)
+	{
+		// Oldest first, keeping the order of the messages that remain
+		auto out = batch_.begin();
+		for (auto it = batch_.begin(); it != batch_.end(); ++it)
+		{
+			if (to_drop > 0 && (*it)->sev == sev)
+			{
+				++shed_by_severity_[sev];  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+				++shed_by_category_[(*it)->category];
+				--to_drop;
+				continue;
+			}
+			if (out != it) *out = std::move(*it);
+			++out;
+		}
+		batch_.erase(out, batch_.end());
+	}
+}
+
+std::map<std::string, size_t> mfviewer::MVReceiver::shedStatistics() const
+{
+	static char const* const names[] = {"debug", "info", "warning", "error"};
+
+	// Not batch_mutex_: a producer holds that while it waits for the consumer, which may be the caller's thread
+	std::lock_guard<std::mutex> lk(shed_mutex_);
+	std::map<std::string, size_t> stats;
+	size_t total = 0;
+	for (int sev = SDEBUG; sev <= SERROR; ++sev)
+	{
+		stats[std::string("messages_shed_") + names[sev]] = shed_by_severity_[sev];  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+		total += shed_by_severity_[sev];                                              // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+	}
+	stats["messages_shed"] = total;
+	for (auto const& category : shed_by_category_)
+	{
+		stats["messages_shed_category:" + category.first] = category.second;
+	}
+	return stats;
 }
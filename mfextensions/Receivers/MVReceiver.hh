@@ -1,23 +1,37 @@
 #ifndef MFVIEWER_MVRECEIVER_H
 #define MFVIEWER_MVRECEIVER_H
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "fhiclcpp/ParameterSet.h"
 
-#include "mfextensions/Receivers/qt_mf_msg.hh"
+#include "mfextensions/Receivers/detail/SPSCQueue.hh"
+#include "mfextensions/Receivers/mf_msg.hh"
 
-#include <QtCore/QThread>
 #include <iostream>
 
 namespace mfviewer {
 /// <summary>
-/// A MVReceiver class listens for messages and raises a signal when one arrives
+/// A MVReceiver class listens for messages on a thread of its own and queues them for a consumer.
+///
+/// Receivers hand messages to queueMessage, which collects them into batches. A batch is moved to the receiver's
+/// output queue once it holds "batch_size" messages, or by flushMessages once its oldest message is
+/// "batch_latency_ms" old. The consumer takes batches with nextBatch; the output queue holds "queue_size" batches.
+///
+/// While the queue is full, messages keep collecting in the current batch. With "overflow_policy" set to "shed"
+/// (the default), once more than "max_pending_messages" are waiting the oldest messages of the lowest severities,
+/// up to "shed_max_severity" (INFO by default, at most WARNING), are dropped and counted; ERROR messages are never
+/// dropped, and if nothing else is left to drop the receiver waits for the consumer. With "block", the receiver
+/// always waits for the consumer. MVReceiver does not depend on Qt; see QtReceiverAdaptor for delivery as Qt signals.
 /// </summary>
-class MVReceiver : public QThread
+class MVReceiver
 {
-	Q_OBJECT
-
 public:
 	/// <summary>
 	/// Construct a MVReceiver using the given ParameterSet
@@ -26,33 +40,107 @@ public:
 	explicit MVReceiver(fhicl::ParameterSet const& pset);
 
 	/// <summary>
-	/// MVReceiver destructor
+	/// MVReceiver destructor. Derived classes must have stopped and waited for the thread before they are destroyed.
+	/// </summary>
+	virtual ~MVReceiver();
+
+	/// <summary>
+	/// Start the receiver thread, which calls run()
 	/// </summary>
-	virtual ~MVReceiver() {}
+	void start();
 
 	/// <summary>
-	/// Stop the MVReceiver thread
+	/// Ask the MVReceiver thread to stop
 	/// </summary>
 	void stop() { stopRequested_ = true; }
 
+	/// <summary>
+	/// Wait for the receiver thread to exit
+	/// </summary>
+	void wait();
+
+	/// <summary>
+	/// Receiver loop, run on the receiver thread until stop() is called
+	/// </summary>
+	virtual void run() = 0;
+
+	/// <summary>
+	/// Counters describing what the receiver has seen so far (messages received, lost, ...), keyed by name.
+	/// May be called from any thread. The default implementation reports nothing.
+	/// </summary>
+	/// <returns>Map of counter name to value</returns>
+	virtual std::map<std::string, size_t> statistics() const { return {}; }
+
+	/// <summary>
+	/// Counters of messages dropped because the consumer fell behind: "messages_shed" in total,
+	/// "messages_shed_&lt;severity&gt;" per severity and "messages_shed_category:&lt;category&gt;" per category.
+	/// May be called from any thread.
+	/// </summary>
+	/// <returns>Map of counter name to value</returns>
+	std::map<std::string, size_t> shedStatistics() const;
+
+	/// <summary>
+	/// (Consumer) Take the oldest queued batch of messages. Must only be called from one thread at a time.
+	/// </summary>
+	/// <param name="batch">Set to the batch, oldest message first</param>
+	/// <returns>False if no batch is waiting</returns>
+	bool nextBatch(mf_msg_batch_t& batch) { return queue_.try_pop(batch); }
+
+	/// <summary>
+	/// Set a function to be called, from a receiver thread, whenever a batch has been queued.
+	/// Must be set before start().
+	/// </summary>
+	/// <param name="notify">Function to call</param>
+	void setNotify(std::function<void()> notify) { notify_ = std::move(notify); }
+
 protected:
 	/// <summary>
 	/// Whether the MVRecevier should stop
 	/// </summary>
 	std::atomic<bool> stopRequested_;
-signals:
+
 	/// <summary>
-	/// When a message is received by the MVReceiver, this signal should be raised so that the connected listener can
-	/// process it.
+	/// Add a message to the current batch, queueing the batch if it is full. May be called from several threads.
 	/// </summary>
 	/// <param name="msg">Received message</param>
-	void NewMessage(msg_ptr_t const& msg);
+	void queueMessage(mf_msg_ptr_t msg);
+
+	/// <summary>
+	/// Queue the current batch if it is older than the configured latency. Receivers should call this regularly,
+	/// and with force set when they run out of input, so that messages are not held back while the receiver is idle.
+	/// </summary>
+	/// <param name="force">Queue any collected messages regardless of their age</param>
+	void flushMessages(bool force);
 
 private:
 	MVReceiver(MVReceiver const&) = delete;
 	MVReceiver(MVReceiver&&) = delete;
 	MVReceiver& operator=(MVReceiver const&) = delete;
 	MVReceiver& operator=(MVReceiver&&) = delete;
+
+	// Called with batch_mutex_ held, which makes the producers of queue_ take turns. Returns true if the batch was queued
+	bool push_batch_();
+	void shed_();
+
+	std::thread thread_;
+
+	size_t batch_size_;
+	std::chrono::steady_clock::duration batch_latency_;
+	mutable std::mutex batch_mutex_;
+	mf_msg_batch_t batch_;
+	std::chrono::steady_clock::time_point batch_start_;
+
+	// Overflow policy, and what it has dropped. The counters are guarded by shed_mutex_, which is only ever held
+	// briefly, so that shedStatistics() does not wait on a producer stalled in push_batch_().
+	bool block_on_overflow_;
+	size_t max_pending_;
+	sev_code_t shed_max_severity_;
+	mutable std::mutex shed_mutex_;
+	size_t shed_by_severity_[SERROR + 1];
+	std::map<std::string, size_t> shed_by_category_;
+
+	detail::SPSCQueue<mf_msg_batch_t> queue_;
+	std::function<void()> notify_;
 };
 }  // namespace mfviewer
 
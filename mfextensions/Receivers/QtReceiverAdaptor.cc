@@ -0,0 +1,36 @@
+#include "mfextensions/Receivers/QtReceiverAdaptor.hh"
+
+#include "fhiclcpp/ParameterSet.h"
+
+mfviewer::QtReceiverAdaptor::QtReceiverAdaptor(const fhicl::ParameterSet& pset)
+    : receivers_(pset)
+    , wakeup_pending_(false)
+{
+	qRegisterMetaType<qt_mf_msg>("qt_mf_msg");
+	qRegisterMetaType<msg_ptr_t>("msg_ptr_t");
+	qRegisterMetaType<msg_batch_t>("msg_batch_t");
+
+	receivers_.setNotify([this] {
+		if (!wakeup_pending_.exchange(true))
+		{
+			QMetaObject::invokeMethod(this, "onMessagesReady", Qt::QueuedConnection);
+		}
+	});
+}
+
+void mfviewer::QtReceiverAdaptor::onMessagesReady()
+{
+	// Clear the flag first, so that batches queued while draining post a new wakeup
+	wakeup_pending_ = false;
+
+	msg_batch_t msgs;
+	receivers_.drain([&msgs](mf_msg_batch_t& batch) {
+		msgs.reserve(msgs.size() + batch.size());
+		for (auto const& msg : batch)
+		{
+			// create() copies the fields into interned and pooled storage; the batch itself is freed once drain returns
+			msgs.push_back(qt_mf_msg::create(*msg));
+		}
+	});
+	if (!msgs.empty()) emit newMessages(msgs);
+}
@@ -0,0 +1,75 @@
+#ifndef mfextensions_Receivers_QtReceiverAdaptor_hh
+#define mfextensions_Receivers_QtReceiverAdaptor_hh
+
+#include <QObject>
+#include "fhiclcpp/fwd.h"
+#include "mfextensions/Receivers/ReceiverManager.hh"
+#include "mfextensions/Receivers/qt_mf_msg.hh"
+
+#include <atomic>
+
+namespace mfviewer {
+/// <summary>
+/// Delivers the messages collected by a ReceiverManager to Qt consumers (the Message Viewer dialog, MsgAnalyzer) as
+/// signals raised in the thread owning the adaptor.
+///
+/// Receivers wake the adaptor with at most one queued event at a time; the adaptor then drains every batch waiting,
+/// converts the messages to qt_mf_msg and raises newMessages once.
+/// </summary>
+class QtReceiverAdaptor : public QObject
+{
+	Q_OBJECT
+
+public:
+	/// <summary>
+	/// QtReceiverAdaptor Constructor
+	/// </summary>
+	/// <param name="pset">ParameterSet used to configure the ReceiverManager</param>
+	explicit QtReceiverAdaptor(fhicl::ParameterSet const& pset);
+
+	/// <summary>
+	/// QtReceiverAdaptor Destructor
+	/// </summary>
+	virtual ~QtReceiverAdaptor() = default;
+
+	/// <summary>
+	/// Start all receivers
+	/// </summary>
+	void start() { receivers_.start(); }
+
+	/// <summary>
+	/// Stop all receivers
+	/// </summary>
+	void stop() { receivers_.stop(); }
+
+	/// <summary>
+	/// Collect the counters of all receivers. Counters with the same name are summed.
+	/// </summary>
+	/// <returns>Map of counter name to value</returns>
+	std::map<std::string, size_t> statistics() const { return receivers_.statistics(); }
+
+signals:
+	/// <summary>
+	/// Signal raised on new messages, one batch at a time
+	/// </summary>
+	/// <param name="msgs">Messages just received</param>
+	void newMessages(msg_batch_t const& msgs);
+
+private slots:
+	/// <summary>
+	/// Drain the receivers and raise newMessages
+	/// </summary>
+	void onMessagesReady();
+
+private:
+	QtReceiverAdaptor(QtReceiverAdaptor const&) = delete;
+	QtReceiverAdaptor(QtReceiverAdaptor&&) = delete;
+	QtReceiverAdaptor& operator=(QtReceiverAdaptor const&) = delete;
+	QtReceiverAdaptor& operator=(QtReceiverAdaptor&&) = delete;
+
+	ReceiverManager receivers_;
+	std::atomic<bool> wakeup_pending_;
+};
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_QtReceiverAdaptor_hh
@@ -5,9 +5,8 @@
 #include "mfextensions/Receivers/makeMVReceiver.hh"
 
 mfviewer::ReceiverManager::ReceiverManager(const fhicl::ParameterSet& pset)
+    : ready_(false)
 {
-	qRegisterMetaType<qt_mf_msg>("qt_mf_msg");
-	qRegisterMetaType<msg_ptr_t>("msg_ptr_t");
 	std::vector<std::string> names = pset.get_pset_names();
 	for (const auto& name : names)
 	{
@@ -17,7 +16,7 @@ mfviewer::ReceiverManager::ReceiverManager(const fhicl::ParameterSet& pset)
 			auto plugin_pset = pset.get<fhicl::ParameterSet>(name);
 			pluginType = plugin_pset.get<std::string>("receiverType", "unknown");
 			std::unique_ptr<mfviewer::MVReceiver> rcvr = makeMVReceiver(pluginType, plugin_pset);
-			connect(rcvr.get(), SIGNAL(NewMessage(msg_ptr_t)), this, SLOT(onNewMessage(msg_ptr_t)));
+			rcvr->setNotify([this] { on_batch_(); });
 			receivers_.push_back(std::move(rcvr));
 		}
 		catch (...)
@@ -57,4 +56,51 @@ void mfviewer::ReceiverManager::start()
 	}
 }
 
-void mfviewer::ReceiverManager::onNewMessage(msg_ptr_t const& mfmsg) { emit newMessage(mfmsg); }
+std::map<std::string, size_t> mfviewer::ReceiverManager::statistics() const
+{
+	std::map<std::string, size_t> totals;
+	for (auto const& receiver : receivers_)
+	{
+		for (auto const& counter : receiver->statistics())
+		{
+			totals[counter.first] += counter.second;
+		}
+		for (auto const& counter : receiver->shedStatistics())
+		{
+			totals[counter.first] += counter.second;
+		}
+	}
+	return totals;
+}
+
+void mfviewer::ReceiverManager::waitForMessages(std::chrono::milliseconds timeout)
+{
+	std::unique_lock<std::mutex> lk(ready_mutex_);
+	ready_cv_.wait_for(lk, timeout, [this] { return ready_; });
+	ready_ = false;
+}
+
+size_t mfviewer::ReceiverManager::drain(std::function<void(mf_msg_batch_t&)> const& consume)
+{
+	size_t count = 0;
+	mf_msg_batch_t batch;
+	for (auto& receiver : receivers_)
+	{
+		while (receiver->nextBatch(batch))
+		{
+			count += batch.size();
+			consume(batch);
+		}
+	}
+	return count;
+}
+
+void mfviewer::ReceiverManager::on_batch_()
+{
+	{
+		std::lock_guard<std::mutex> lk(ready_mutex_);
+		ready_ = true;
+	}
+	ready_cv_.notify_all();
+	if (notify_) notify_();
+}
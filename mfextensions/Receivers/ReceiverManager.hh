@@ -1,19 +1,24 @@
 #ifndef RECEIVER_MANAGER_H
 #define RECEIVER_MANAGER_H
 
-#include <QObject>
 #include "fhiclcpp/fwd.h"
 #include "mfextensions/Receivers/MVReceiver.hh"
 
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace mfviewer {
 /// <summary>
-/// The ReceiverManager loads one or more receiver plugins and displays messages received by those plugins on the
-/// Message Viewer dialog
+/// The ReceiverManager loads one or more receiver plugins and collects the messages they receive.
+///
+/// Consumers either call waitForMessages and drain in a loop of their own, or register a notification function
+/// (see QtReceiverAdaptor) and drain when it is called. ReceiverManager does not depend on Qt.
 /// </summary>
-class ReceiverManager : public QObject
+class ReceiverManager
 {
-	Q_OBJECT
-
 public:
 	/// <summary>
 	/// ReceiverManager Constructor
@@ -36,19 +41,32 @@ public:
 	/// </summary>
 	void stop();
 
-signals:
 	/// <summary>
-	/// Signal raised on new message
+	/// Collect the counters of all receivers, including the messages they shed because the consumer fell behind
+	/// (see MVReceiver::shedStatistics). Counters with the same name are summed.
+	/// </summary>
+	/// <returns>Map of counter name to value</returns>
+	std::map<std::string, size_t> statistics() const;
+
+	/// <summary>
+	/// Set a function to be called, from a receiver thread, whenever messages are ready to be drained.
+	/// Must be set before start().
 	/// </summary>
-	/// <param name="msg">Message just received</param>
-	void newMessage(msg_ptr_t const& msg);
+	/// <param name="notify">Function to call</param>
+	void setNotify(std::function<void()> notify) { notify_ = std::move(notify); }
 
-private slots:
 	/// <summary>
-	/// Slot connected to receivers' newMessage signal
+	/// Wait until messages may be ready to be drained
 	/// </summary>
-	/// <param name="mfmsg">Message received by receiver</param>
-	void onNewMessage(msg_ptr_t const& mfmsg);
+	/// <param name="timeout">Longest time to wait</param>
+	void waitForMessages(std::chrono::milliseconds timeout);
+
+	/// <summary>
+	/// Hand every queued batch of messages to a function. Must only be called from one thread at a time.
+	/// </summary>
+	/// <param name="consume">Function called with each batch</param>
+	/// <returns>Number of messages drained</returns>
+	size_t drain(std::function<void(mf_msg_batch_t&)> const& consume);
 
 private:
 	ReceiverManager(ReceiverManager const&) = delete;
@@ -56,7 +74,14 @@ private:
 	ReceiverManager& operator=(ReceiverManager const&) = delete;
 	ReceiverManager& operator=(ReceiverManager&&) = delete;
 
+	void on_batch_();
+
 	std::vector<std::unique_ptr<mfviewer::MVReceiver>> receivers_;
+	std::function<void()> notify_;
+
+	std::mutex ready_mutex_;
+	std::condition_variable ready_cv_;
+	bool ready_;
 };
 }  // namespace mfviewer
 
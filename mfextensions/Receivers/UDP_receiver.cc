@@ -2,10 +2,14 @@
 
 #include "mfextensions/Receivers/UDP_receiver.hh"
 #include <sys/poll.h>
-#include <sstream>
+#include <algorithm>
 #include "messagefacility/Utilities/ELseverityLevel.h"
 #include "mfextensions/Receivers/ReceiverMacros.hh"
 #include "mfextensions/Receivers/detail/TCPConnect.hh"
+#include "mfextensions/Receivers/detail/UDPTextParser.hh"
+#include "mfextensions/Receivers/detail/UDPWireFormat.hh"
+
+static_assert(mfviewer::detail::MAX_SEVERITY == mf::ELseverityLevel::ELsev_highestSeverity, "The wire format severity limit must match messagefacility");
 
 mfviewer::UDPReceiver::UDPReceiver(fhicl::ParameterSet const& pset)
     : MVReceiver(pset)
@@ -13,17 +17,38 @@ mfviewer::UDPReceiver::UDPReceiver(fhicl::ParameterSet const& pset)
     , message_addr_(pset.get<std::string>("message_address", "227.128.12.27"))
     , multicast_enable_(pset.get<bool>("multicast_enable", false))
     , multicast_out_addr_(pset.get<std::string>("multicast_interface_ip", "0.0.0.0"))
-    , message_socket_(-1)
+    , receive_buffer_size_(pset.get<int>("socket_receive_buffer_size", 0))
+    , receive_batch_size_(std::max(size_t{1}, pset.get<size_t>("receive_batch_size", 32)))
+    , shards_()
 {
 	TLOG(TLVL_DEBUG + 33) << "UDPReceiver Constructor";
-	this->setObjectName("viewer UDP");
+
+	auto threads = pset.get<size_t>("threads", 1);
+	if (threads == 0) threads = 1;
+	if (threads > 1 && multicast_enable_)
+	{
+		// Every socket in a multicast group receives every datagram, so extra sockets would only duplicate messages
+		TLOG(TLVL_WARNING) << "threads=" << threads << " is not supported with multicast_enable, using 1 thread";
+		threads = 1;
+	}
+
+	auto ring_size = pset.get<size_t>("receive_ring_size", 128);
+	if (receive_batch_size_ > ring_size) receive_batch_size_ = ring_size;
+	for (size_t ii = 0; ii < threads; ++ii)
+	{
+		shards_.push_back(std::make_unique<Shard>(ii, ring_size, receive_batch_size_,
+		                                          pset.get<size_t>("max_pending_fragmented_messages", 256),
+		                                          pset.get<size_t>("max_fragmented_message_size", 16 * 1024 * 1024),
+		                                          pset.get<size_t>("max_pending_fragment_bytes", 64 * 1024 * 1024),
+		                                          std::chrono::milliseconds(pset.get<int>("fragment_timeout_ms", 2000))));
+	}
 }
 
-void mfviewer::UDPReceiver::setupMessageListener_()
+void mfviewer::UDPReceiver::setupMessageListener_(Shard& shard)
 {
 	TLOG(TLVL_INFO) << "Setting up message listen socket, address=" << message_addr_ << ":" << message_port_;
-	message_socket_ = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-	if (message_socket_ < 0)
+	shard.message_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (shard.message_socket < 0)
 	{
 		TLOG(TLVL_ERROR) << "Error creating socket for receiving messages! err=" << strerror(errno);
 		exit(1);
@@ -32,16 +57,41 @@ void mfviewer::UDPReceiver::setupMessageListener_()
 	struct sockaddr_in si_me_request;
 
 	int yes = 1;
-	if (setsockopt(message_socket_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0)
+	if (setsockopt(shard.message_socket, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes)) < 0)
 	{
 		TLOG(TLVL_ERROR) << "Unable to enable port reuse on message socket, err=" << strerror(errno);
 		exit(1);
 	}
+	// With several threads, each binds its own socket to the port and the kernel spreads senders across them
+	if (shards_.size() > 1 && setsockopt(shard.message_socket, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes)) < 0)
+	{
+		TLOG(TLVL_ERROR) << "Unable to enable SO_REUSEPORT on message socket, err=" << strerror(errno);
+		exit(1);
+	}
+	if (receive_buffer_size_ > 0)
+	{
+		int len = receive_buffer_size_;
+		if (setsockopt(shard.message_socket, SOL_SOCKET, SO_RCVBUF, &len, sizeof(len)) < 0)
+		{
+			TLOG(TLVL_WARNING) << "Unable to set receive buffer size to " << receive_buffer_size_ << ", err=" << strerror(errno);
+		}
+		socklen_t lenlen = sizeof(len);
+		if (getsockopt(shard.message_socket, SOL_SOCKET, SO_RCVBUF, &len, &lenlen) == 0)
+		{
+			TLOG(TLVL_INFO) << "Message socket receive buffer size is " << len << " bytes";
+		}
+	}
+	// Have the kernel report how many datagrams it dropped because the receive buffer was full
+	if (setsockopt(shard.message_socket, SOL_SOCKET, SO_RXQ_OVFL, &yes, sizeof(yes)) < 0)
+	{
+		TLOG(TLVL_WARNING) << "Unable to enable drop reporting on message socket, err=" << strerror(errno);
+	}
+	shard.socket_drops = 0;
 	memset(&si_me_request, 0, sizeof(si_me_request));
 	si_me_request.sin_family = AF_INET;
 	si_me_request.sin_port = htons(message_port_);
 	si_me_request.sin_addr.s_addr = htonl(INADDR_ANY);
-	if (bind(message_socket_, reinterpret_cast<struct sockaddr*>(&si_me_request), sizeof(si_me_request)) == -1)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	if (bind(shard.message_socket, reinterpret_cast<struct sockaddr*>(&si_me_request), sizeof(si_me_request)) == -1)  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 	{
 		TLOG(TLVL_ERROR) << "Cannot bind message socket to port " << message_port_ << ", err=" << strerror(errno);
 		exit(1);
@@ -62,7 +112,7 @@ void mfviewer::UDPReceiver::setupMessageListener_()
 			TLOG(TLVL_ERROR) << "Unable to resolve hostname for " << multicast_out_addr_;
 			exit(1);
 		}
-		if (setsockopt(message_socket_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
+		if (setsockopt(shard.message_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0)
 		{
 			TLOG(TLVL_ERROR) << "Unable to join multicast group, err=" << strerror(errno);
 			exit(1);
@@ -73,20 +123,86 @@ void mfviewer::UDPReceiver::setupMessageListener_()
 
 mfviewer::UDPReceiver::~UDPReceiver()
 {
-	TLOG(TLVL_DEBUG + 32) << "Closing message receive socket";
-	close(message_socket_);
-	message_socket_ = -1;
+	stop();
+	wait();
+	for (auto& shard : shards_)
+	{
+		if (shard->receive_thread.joinable()) shard->receive_thread.join();
+		if (shard->parse_thread.joinable()) shard->parse_thread.join();
+
+		auto const& stats = shard->reassembler.stats();
+		TLOG(TLVL_DEBUG + 32) << "Fragmented messages (thread " << shard->index << "): completed=" << stats.completed
+		                      << ", incomplete=" << stats.incomplete << ", rejected fragments=" << stats.rejected
+		                      << ", duplicate fragments=" << stats.duplicates;
+		TLOG(TLVL_DEBUG + 32) << "Closing message receive socket " << shard->index;
+		if (shard->message_socket != -1) close(shard->message_socket);
+		shard->message_socket = -1;
+	}
 }
 
 void mfviewer::UDPReceiver::run()
+{
+	for (auto& shard : shards_)
+	{
+		shard->receive_thread = std::thread([this, &shard = *shard] { receive_loop_(shard); });
+	}
+	// The first shard is parsed on this thread, the others on threads of their own
+	for (size_t ii = 1; ii < shards_.size(); ++ii)
+	{
+		shards_[ii]->parse_thread = std::thread([this, &shard = *shards_[ii]] { parse_loop_(shard); });
+	}
+
+	parse_loop_(*shards_[0]);
+
+	for (auto& shard : shards_)
+	{
+		if (shard->parse_thread.joinable()) shard->parse_thread.join();
+		shard->receive_thread.join();
+	}
+	TLOG(TLVL_INFO) << "UDPReceiver shutting down!";
+}
+
+void mfviewer::UDPReceiver::parse_loop_(Shard& shard)
+{
+	while (true)
+	{
+		expire_fragments_(shard);
+
+		auto ready = shard.ring.ready();
+		if (ready == 0)
+		{
+			// Out of input: deliver what has been collected rather than wait for the batch to fill
+			flushMessages(true);
+			if (stopRequested_) break;
+
+			std::unique_lock<std::mutex> lk(shard.ring_mutex);
+			shard.ring_cv.wait_for(lk, std::chrono::milliseconds(10), [this, &shard] { return shard.ring.ready() > 0 || stopRequested_; });
+			continue;
+		}
+
+		for (size_t ii = 0; ii < ready; ++ii)
+		{
+			auto const& slot = shard.ring.read_slot(ii);
+			handle_datagram_(shard, slot.data.data(), slot.size);
+		}
+		shard.ring.release(ready);
+		flushMessages(false);
+		{
+			std::lock_guard<std::mutex> lk(shard.ring_mutex);
+		}
+		shard.ring_cv.notify_all();
+	}
+}
+
+void mfviewer::UDPReceiver::receive_loop_(Shard& shard)
 {
 	while (!stopRequested_)
 	{
-		if (message_socket_ == -1) setupMessageListener_();
+		if (shard.message_socket == -1) setupMessageListener_(shard);
 
 		int ms_to_wait = 10;
 		struct pollfd ufds[1];
-		ufds[0].fd = message_socket_;
+		ufds[0].fd = shard.message_socket;
 		ufds[0].events = POLLIN | POLLPRI | POLLERR;
 		int rv = poll(ufds, 1, ms_to_wait);
 
@@ -95,199 +211,378 @@ void mfviewer::UDPReceiver::run()
 		{
 			if (rv == 1 && (ufds[0].revents & (POLLNVAL | POLLERR | POLLHUP)))
 			{
-				close(message_socket_);
-				message_socket_ = -1;
-			}
-			if (stopRequested_)
-			{
-				break;
+				close(shard.message_socket);
+				shard.message_socket = -1;
 			}
 			continue;
 		}
 
-		char buffer[TRACE_STREAMER_MSGMAX + 1];
-		auto packetSize = read(message_socket_, &buffer, TRACE_STREAMER_MSGMAX);
-		if (packetSize < 0)
+		// Empty the socket before polling again
+		size_t received;
+		do
+		{
+			received = drain_socket_(shard);
+		} while (!stopRequested_ && received == receive_batch_size_);
+	}
+}
+
+size_t mfviewer::UDPReceiver::drain_socket_(Shard& shard)
+{
+	auto space = shard.ring.free_slots();
+	if (space == 0)
+	{
+		// The parser is behind; the socket buffer absorbs datagrams until it catches up
+		++shard.ring_full_waits;
+		std::unique_lock<std::mutex> lk(shard.ring_mutex);
+		shard.ring_cv.wait_for(lk, std::chrono::milliseconds(10), [this, &shard] { return shard.ring.free_slots() > 0 || stopRequested_; });
+		return receive_batch_size_;
+	}
+
+	auto const count = std::min(space, receive_batch_size_);
+	auto const control_size = CMSG_SPACE(sizeof(uint32_t));
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		auto& slot = shard.ring.write_slot(ii);
+		shard.iov[ii].iov_base = slot.data.data();
+		shard.iov[ii].iov_len = slot.data.size();
+		memset(&shard.mmsg[ii], 0, sizeof(shard.mmsg[ii]));
+		shard.mmsg[ii].msg_hdr.msg_iov = &shard.iov[ii];
+		shard.mmsg[ii].msg_hdr.msg_iovlen = 1;
+		shard.mmsg[ii].msg_hdr.msg_control = &shard.control[ii * control_size];
+		shard.mmsg[ii].msg_hdr.msg_controllen = control_size;
+	}
+
+	auto received = recvmmsg(shard.message_socket, shard.mmsg.data(), count, MSG_DONTWAIT, nullptr);
+	if (received < 0)
+	{
+		if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
 		{
 			TLOG(TLVL_ERROR) << "Error receiving message, errno=" << errno << " (" << strerror(errno) << ")";
 		}
-		else
+		return 0;
+	}
+
+	for (int ii = 0; ii < received; ++ii)
+	{
+		auto& hdr = shard.mmsg[ii].msg_hdr;
+		shard.ring.write_slot(ii).size = shard.mmsg[ii].msg_len;
+		if (hdr.msg_flags & MSG_TRUNC)
+		{
+			TLOG(TLVL_WARNING) << "Received datagram larger than the receive buffer; it was truncated";
+		}
+
+		for (auto* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg))
 		{
-			TLOG(TLVL_DEBUG + 33) << "Recieved message; validating...(packetSize=" << packetSize << ")";
-			std::string message(buffer, buffer + packetSize);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			if (validate_packet(message))
+			if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL)
 			{
-				TLOG(TLVL_DEBUG + 33) << "Valid UDP Message received! Sending to GUI!";
-				emit NewMessage(read_msg(message));
+				uint32_t drops;
+				memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+				if (drops > shard.socket_drops)
+				{
+					TLOG(TLVL_WARNING) << "Kernel dropped " << (drops - shard.socket_drops) << " datagrams because the receive buffer was full";
+					shard.kernel_drops += drops - shard.socket_drops;
+					shard.socket_drops = drops;
+				}
 			}
 		}
 	}
-	TLOG(TLVL_INFO) << "UDPReceiver shutting down!";
+
+	shard.packets_received += received;
+	shard.ring.publish(received);
+	{
+		std::lock_guard<std::mutex> lk(shard.ring_mutex);
+	}
+	shard.ring_cv.notify_all();
+
+	return static_cast<size_t>(received);
 }
 
-std::list<std::string> mfviewer::UDPReceiver::tokenize_(std::string const& input)
+void mfviewer::UDPReceiver::handle_datagram_(Shard& shard, char const* buffer, size_t size)
 {
-	size_t pos = 0;
-	std::list<std::string> output;
+	TLOG(TLVL_DEBUG + 33) << "Recieved message; validating...(packetSize=" << size << ")";
+	if (detail::is_framed(buffer, size))
+	{
+		auto ok = detail::unpack_frame(buffer, size, [this, &shard](char const* record, size_t len) { handle_payload_(shard, record, len); });
+		if (!ok)
+		{
+			TLOG(TLVL_WARNING) << "Received malformed or truncated framed packet (packetSize=" << size << ")";
+		}
+	}
+	else
+	{
+		handle_payload_(shard, buffer, size);
+	}
+}
 
-	while (pos != std::string::npos && pos < input.size())
+void mfviewer::UDPReceiver::handle_payload_(Shard& shard, char const* buffer, size_t size)
+{
+	if (detail::is_fragment(buffer, size))
 	{
-		auto newpos = input.find('|', pos);
-		if (newpos != std::string::npos)
+		handle_fragment_(shard, buffer, size);
+		return;
+	}
+	if (detail::is_dictionary(buffer, size))
+	{
+		update_dictionary_(shard, buffer, size);
+		return;
+	}
+	if (detail::is_dictionary_record(buffer, size))
+	{
+		auto msg = read_dictionary_msg(shard, buffer, size);
+		if (msg)
 		{
-			output.emplace_back(input, pos, newpos - pos);
-			// TLOG(TLVL_DEBUG + 33) << "tokenize_: " << output.back();
-			pos = newpos + 1;
+			TLOG(TLVL_DEBUG + 33) << "Valid dictionary UDP Message received! Sending to GUI!";
+			queueMessage(std::move(msg));
 		}
-		else
+		return;
+	}
+	if (detail::is_binary_record(buffer, size))
+	{
+		auto msg = read_binary_msg(shard, buffer, size);
+		if (msg)
 		{
-			output.emplace_back(input, pos);
-			// TLOG(TLVL_DEBUG + 33) << "tokenize_: " << output.back();
-			pos = newpos;
+			TLOG(TLVL_DEBUG + 33) << "Valid binary UDP Message received! Sending to GUI!";
+			queueMessage(std::move(msg));
 		}
+		return;
+	}
+
+	std::string_view message(buffer, size);
+	if (validate_packet(message))
+	{
+		TLOG(TLVL_DEBUG + 33) << "Valid UDP Message received! Sending to GUI!";
+		queueMessage(read_msg(shard, message));
 	}
-	return output;
 }
 
-msg_ptr_t mfviewer::UDPReceiver::read_msg(std::string const& input)
+mf_msg_ptr_t mfviewer::UDPReceiver::read_msg(Shard& shard, std::string_view input)
 {
-	std::string hostname, category, application, message, hostaddr, file, line, module, eventID;
-	mf::ELseverityLevel sev;
-	timeval tv = {0, 0};
-	int pid = 0;
-	int seqNum = 0;
-
 	TLOG(TLVL_DEBUG + 33) << "Recieved MF/Syslog message with contents: " << input;
 
-	auto tokens = tokenize_(input);
-	auto it = tokens.begin();
+	detail::TextMessageFields fields;
+	detail::UDPTextParser::parse(input, shard.timestamps, fields);
+	TLOG(TLVL_DEBUG + 33) << "Message content: " << fields.body;
+
+	// Messages from senders other than ELUDP carry no sequence number
+	std::string hostname(fields.hostname);
+	if (fields.seqNum > 0) track_sequence_(shard, hostname, fields.pid, fields.seqNum);
 
-	if (it != tokens.end())
+	auto msg = mf_msg::create();
+	msg->hostname = std::move(hostname);
+	msg->hostaddr = fields.hostaddr;
+	msg->category = fields.category;
+	msg->application = fields.application;
+	msg->pid = fields.pid;
+	msg->time = fields.time;
+	msg->sev = mf_msg::severity_code(fields.severity.empty() ? mf::ELseverityLevel() : mf::ELseverityLevel(std::string(fields.severity)));
+	msg->sourceType = "UDPMessage";
+	msg->sourceSequence = fields.seqNum;
+	msg->file = fields.file;
+	msg->line = fields.line;
+	msg->module = fields.module;
+	msg->eventID = fields.iteration;
+	msg->message = fields.body;
+
+	return msg;
+}
+
+mf_msg_ptr_t mfviewer::UDPReceiver::read_binary_msg(Shard& shard, char const* buffer, size_t size)
+{
+	detail::BinaryRecord rec;
+	if (!detail::decode_binary_record(buffer, size, rec))
 	{
-		bool timestamp_found = false;
-		struct tm tm;
-		time_t t;
-		while (it != tokens.end() && !timestamp_found)
-		{
-			std::string thisString = *it;
-			while (!thisString.empty() && !timestamp_found)
-			{
-				auto pos = thisString.find_first_of("0123456789");
-				if (pos != std::string::npos)
-				{
-					thisString = thisString.erase(0, pos);
-					// TLOG(TLVL_DEBUG + 33) << "thisString: " << thisString;
+		TLOG(TLVL_WARNING) << "Received malformed or unsupported binary message (size=" << size << ")";
+		return nullptr;
+	}
 
-					if (strptime(thisString.c_str(), "%d-%b-%Y %H:%M:%S", &tm) != nullptr)
-					{
-						timestamp_found = true;
-						break;
-					}
+	track_sequence_(shard, std::string(rec.hostname), rec.pid, rec.seqNum);
 
-					if (!thisString.empty())
-						thisString = thisString.erase(0, 1);
-				}
-			}
-			++it;
-		}
+	timeval tv;
+	tv.tv_sec = static_cast<time_t>(rec.timestamp_us / 1000000);
+	tv.tv_usec = static_cast<suseconds_t>(rec.timestamp_us % 1000000);
 
-		tm.tm_isdst = -1;
-		t = mktime(&tm);
-		tv.tv_sec = t;
-		tv.tv_usec = 0;
+	auto msg = mf_msg::create();
+	msg->hostname = rec.hostname;
+	msg->hostaddr = rec.hostaddr;
+	msg->category = rec.category;
+	msg->application = rec.application;
+	msg->pid = rec.pid;
+	msg->time = tv;
+	msg->sev = mf_msg::severity_code(mf::ELseverityLevel(static_cast<mf::ELseverityLevel::ELsev_>(rec.severity)));
+	msg->sourceType = "UDPMessage";
+	msg->sourceSequence = rec.seqNum;
+	msg->file = rec.file;
+	msg->line = std::to_string(rec.line);
+	msg->module = rec.module;
+	msg->eventID = rec.iteration;
+	msg->message = rec.message;
 
-		auto prevIt = it;
-		try
-		{
-			if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-			{
-				seqNum = std::stoi(*it);
-			}
-		}
-		catch (const std::invalid_argument& e)
-		{
-			it = prevIt;
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-		{
-			hostname = *it;
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-		{
-			hostaddr = *it;
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-		{
-			sev = mf::ELseverityLevel(*it);
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-		{
-			category = *it;
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-		{
-			application = *it;
-		}
-		prevIt = it;
-		try
-		{
-			if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-			{
-				pid = std::stol(*it);
-			}
-		}
-		catch (const std::invalid_argument& e)
-		{
-			it = prevIt;
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-		{
-			eventID = *it;
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-		{
-			module = *it;
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
-		{
-			file = *it;
-		}
-		if (it != tokens.end() && ++it != tokens.end() /* Advances it */)
+	return msg;
+}
+
+void mfviewer::UDPReceiver::handle_fragment_(Shard& shard, char const* buffer, size_t size)
+{
+	detail::FragmentHeader hdr;
+	std::string_view data;
+	if (!detail::decode_fragment(buffer, size, hdr, data))
+	{
+		TLOG(TLVL_WARNING) << "Received malformed or unsupported message fragment (size=" << size << ")";
+		return;
+	}
+
+	std::string complete;
+	bool done;
+	{
+		std::lock_guard<std::mutex> lk(shard.stats_mutex);
+		done = shard.reassembler.add(hdr, data, std::chrono::steady_clock::now(), complete);
+	}
+	if (done)
+	{
+		TLOG(TLVL_DEBUG + 33) << "Reassembled " << complete.size() << " byte message from " << hdr.count << " fragments";
+		handle_payload_(shard, complete.data(), complete.size());
+	}
+}
+
+void mfviewer::UDPReceiver::expire_fragments_(Shard& shard)
+{
+	if (shard.reassembler.pending() == 0) return;
+
+	auto now = std::chrono::steady_clock::now();
+	if (now - shard.last_fragment_expire < std::chrono::milliseconds(100)) return;
+	shard.last_fragment_expire = now;
+
+	std::lock_guard<std::mutex> lk(shard.stats_mutex);
+	if (shard.reassembler.expire(now) > 0 && shard.reassembler.stats().incomplete >= shard.next_incomplete_report)
+	{
+		TLOG(TLVL_WARNING) << "Dropped fragmented messages that did not arrive in full; " << shard.reassembler.stats().incomplete
+		                   << " incomplete messages so far";
+		shard.next_incomplete_report = shard.reassembler.stats().incomplete * 10;
+	}
+}
+
+void mfviewer::UDPReceiver::track_sequence_(Shard& shard, std::string const& host, int64_t pid, int64_t seqNum, uint64_t session)
+{
+	std::lock_guard<std::mutex> lk(shard.stats_mutex);
+	shard.sequence_tracker.record(host, pid, seqNum, session);
+}
+
+std::map<std::string, size_t> mfviewer::UDPReceiver::statistics() const
+{
+	std::map<std::string, size_t> totals;
+	for (auto const& shard : shards_)
+	{
+		std::lock_guard<std::mutex> lk(shard->stats_mutex);
+		auto const& seq = shard->sequence_tracker.stats();
+		auto const& frag = shard->reassembler.stats();
+		totals["packets"] += shard->packets_received;
+		totals["packets_dropped_by_kernel"] += shard->kernel_drops;
+		totals["receive_ring_full"] += shard->ring_full_waits;
+		totals["messages"] += seq.received;
+		totals["messages_missing"] += seq.missing;
+		totals["messages_duplicated"] += seq.duplicates;
+		totals["messages_reordered"] += seq.reordered;
+		totals["sender_restarts"] += seq.resets;
+		totals["senders"] += seq.senders;
+		totals["fragmented_messages"] += frag.completed;
+		totals["fragmented_messages_incomplete"] += frag.incomplete;
+		totals["dictionary_messages_unresolved"] += shard->unresolved_dictionary_msgs;
+	}
+	return totals;
+}
+
+void mfviewer::UDPReceiver::update_dictionary_(Shard& shard, char const* buffer, size_t size)
+{
+	uint64_t session = 0;
+	uint32_t pid = 0;
+	auto now = time(nullptr);
+	SenderDictionary* dict = nullptr;
+
+	auto ok = detail::unpack_dictionary(buffer, size, session, pid, [&](uint16_t id, std::string_view str) {
+		if (dict == nullptr)
 		{
-			line = *it;
+			dict = &shard.dictionaries[session];
+			dict->pid = pid;
+			dict->last_update = now;
 		}
-		std::ostringstream oss;
-		bool first = true;
-		while (it != tokens.end() && ++it != tokens.end() /* Advances it */)
+		dict->strings[id] = std::string(str);
+	});
+	if (!ok)
+	{
+		TLOG(TLVL_WARNING) << "Received malformed or unsupported dictionary announcement (size=" << size << ")";
+	}
+
+	// Senders re-announce their tables periodically; forget the ones that have gone quiet
+	if (now - shard.last_dictionary_prune > DICTIONARY_EXPIRY_S)
+	{
+		for (auto it = shard.dictionaries.begin(); it != shard.dictionaries.end();)
 		{
-			if (!first)
-			{
-				oss << "|";
-			}
+			if (now - it->second.last_update > DICTIONARY_EXPIRY_S)
+				it = shard.dictionaries.erase(it);
 			else
-			{
-				first = false;
-			}
-			oss << *it;
+				++it;
 		}
-		TLOG(TLVL_DEBUG + 33) << "Message content: " << oss.str();
-		message = oss.str();
+		shard.last_dictionary_prune = now;
 	}
+}
 
-	auto msg = std::make_shared<qt_mf_msg>(hostname, category, application, pid, tv);
-	msg->setSeverity(sev);
-	msg->setMessage("UDPMessage", seqNum, message);
-	msg->setHostAddr(hostaddr);
-	msg->setFileName(file);
-	msg->setLineNumber(line);
-	msg->setModule(module);
-	msg->setEventID(eventID);
-	msg->updateText();
+mf_msg_ptr_t mfviewer::UDPReceiver::read_dictionary_msg(Shard& shard, char const* buffer, size_t size)
+{
+	detail::DictionaryRecord rec;
+	if (!detail::decode_dictionary_record(buffer, size, rec))
+	{
+		TLOG(TLVL_WARNING) << "Received malformed or unsupported dictionary message (size=" << size << ")";
+		return nullptr;
+	}
+
+	SenderDictionary const* dict = nullptr;
+	auto dictIt = shard.dictionaries.find(rec.session);
+	if (dictIt != shard.dictionaries.end()) dict = &dictIt->second;
+
+	bool resolved = true;
+	auto lookup = [&](uint16_t id) {
+		if (dict != nullptr)
+		{
+			auto it = dict->strings.find(id);
+			if (it != dict->strings.end()) return it->second;
+		}
+		resolved = false;
+		return "<id " + std::to_string(id) + ">";
+	};
+
+	// Until its table arrives, the sender's (host, pid) is unknown and the message cannot be accounted for
+	if (dict != nullptr) track_sequence_(shard, lookup(rec.hostname), dict->pid, rec.seqNum, rec.session);
+
+	timeval tv;
+	tv.tv_sec = static_cast<time_t>(rec.timestamp_us / 1000000);
+	tv.tv_usec = static_cast<suseconds_t>(rec.timestamp_us % 1000000);
+
+	auto msg = mf_msg::create();
+	msg->hostname = lookup(rec.hostname);
+	msg->hostaddr = lookup(rec.hostaddr);
+	msg->category = lookup(rec.category);
+	msg->application = lookup(rec.application);
+	msg->pid = dict != nullptr ? dict->pid : 0;
+	msg->time = tv;
+	msg->sev = mf_msg::severity_code(mf::ELseverityLevel(static_cast<mf::ELseverityLevel::ELsev_>(rec.severity)));
+	msg->sourceType = "UDPMessage";
+	msg->sourceSequence = rec.seqNum;
+	msg->file = lookup(rec.file);
+	msg->line = std::to_string(rec.line);
+	msg->module = lookup(rec.module);
+	msg->eventID = rec.iteration;
+	msg->message = rec.message;
+
+	if (!resolved)
+	{
+		auto unresolved = ++shard.unresolved_dictionary_msgs;
+		TLOG(TLVL_DEBUG + 33) << "Message from session " << std::hex << rec.session << std::dec
+		                      << " refers to ids not yet announced (" << unresolved << " so far)";
+	}
 
 	return msg;
 }
 
-bool mfviewer::UDPReceiver::validate_packet(std::string const& input)
+bool mfviewer::UDPReceiver::validate_packet(std::string_view input)
 {
 	// Run some checks on the input packet
 	if (input.find("MF") == std::string::npos)
@@ -303,6 +598,4 @@ bool mfviewer::UDPReceiver::validate_packet(std::string const& input)
 	return true;
 }
 
-#include "moc_UDP_receiver.cpp"
-
 DEFINE_MFVIEWER_RECEIVER(mfviewer::UDPReceiver)
@@ -4,14 +4,36 @@
 #include "mfextensions/Receivers/MVReceiver.hh"
 
 #include "messagefacility/MessageLogger/MessageLogger.h"
+#include "mfextensions/Receivers/detail/FragmentReassembler.hh"
+#include "mfextensions/Receivers/detail/PacketRing.hh"
+#include "mfextensions/Receivers/detail/SequenceTracker.hh"
+#include "mfextensions/Receivers/detail/TimestampDecoder.hh"
+#include "mfextensions/Receivers/detail/UDPWireFormat.hh"
+
+#include <sys/socket.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace mfviewer {
 /// <summary>
-/// Receive messages through a UDP socket. Expects the syslog format provided by UDP_mfPlugin (ELUDP)
+/// Receive messages through a UDP socket. Expects the syslog format provided by UDP_mfPlugin (ELUDP), either one
+/// message per datagram or several messages packed into a framed datagram, in either the text or binary encoding.
+/// Messages too large for one datagram arrive as fragments and are reassembled before being decoded.
+///
+/// A dedicated thread drains the socket with recvmmsg into a ring of reusable buffers; the receiver's own thread
+/// parses them, so that the socket is emptied at the rate the kernel fills it, not at the rate messages are parsed.
+///
+/// With "threads" greater than one, that many sockets are bound to the port with SO_REUSEPORT, each with its own
+/// receive and parse threads. The kernel hashes each sender to one socket, so per-sender state (sequence numbers,
+/// fragments, dictionaries) stays local to a shard. Not available with multicast.
 /// </summary>
 class UDPReceiver : public MVReceiver
 {
-	Q_OBJECT
 public:
 	/// <summary>
 	/// UDPReceiver Constructor
@@ -25,39 +47,133 @@ public:
 	virtual ~UDPReceiver();
 
 	/// <summary>
-	/// Receiver method. Receive messages and emit NewMessage signal
+	/// Receiver method. Parse datagrams collected by the socket thread and queue the messages
 	/// </summary>
 	void run() override;
 
+	/// <summary>
+	/// Report message counts, loss accounting from the sender sequence numbers, and fragment reassembly counters
+	/// </summary>
+	/// <returns>Map of counter name to value</returns>
+	std::map<std::string, size_t> statistics() const override;
+
+private:
+	UDPReceiver(UDPReceiver const&) = delete;
+	UDPReceiver(UDPReceiver&&) = delete;
+	UDPReceiver& operator=(UDPReceiver const&) = delete;
+	UDPReceiver& operator=(UDPReceiver&&) = delete;
+
+	// Everything owned by one socket: the ring its receive thread fills, and the state used to parse its datagrams
+	struct Shard;
+
+	void setupMessageListener_(Shard& shard);
+	void receive_loop_(Shard& shard);
+	size_t drain_socket_(Shard& shard);
+	void parse_loop_(Shard& shard);
+	void handle_datagram_(Shard& shard, char const* buffer, size_t size);
+	void handle_payload_(Shard& shard, char const* buffer, size_t size);
+	void update_dictionary_(Shard& shard, char const* buffer, size_t size);
+	void handle_fragment_(Shard& shard, char const* buffer, size_t size);
+	void expire_fragments_(Shard& shard);
+	void track_sequence_(Shard& shard, std::string const& host, int64_t pid, int64_t seqNum, uint64_t session = 0);
+
 	/// <summary>
 	/// Parse incoming message
 	/// </summary>
+	/// <param name="shard">Shard which received the message</param>
 	/// <param name="input">String to parse</param>
-	/// <returns>qt_mf_msg object containing message data</returns>
-	msg_ptr_t read_msg(std::string const& input);
+	/// <returns>mf_msg object containing message data</returns>
+	mf_msg_ptr_t read_msg(Shard& shard, std::string_view input);
+
+	/// <summary>
+	/// Decode a message sent in the binary wire format
+	/// </summary>
+	/// <param name="shard">Shard which received the message</param>
+	/// <param name="buffer">Start of the binary record</param>
+	/// <param name="size">Size of the binary record</param>
+	/// <returns>mf_msg object containing message data, or nullptr if the record is malformed</returns>
+	mf_msg_ptr_t read_binary_msg(Shard& shard, char const* buffer, size_t size);
+
+	/// <summary>
+	/// Decode a message sent in the dictionary wire format, resolving its string ids against the sender's
+	/// announced table. Ids that have not been announced yet are rendered as "&lt;id N&gt;".
+	/// </summary>
+	/// <param name="shard">Shard which received the message</param>
+	/// <param name="buffer">Start of the dictionary message record</param>
+	/// <param name="size">Size of the dictionary message record</param>
+	/// <returns>mf_msg object containing message data, or nullptr if the record is malformed</returns>
+	mf_msg_ptr_t read_dictionary_msg(Shard& shard, char const* buffer, size_t size);
 
 	/// <summary>
 	/// Run simple validation tests on message
 	/// </summary>
 	/// <param name="input">String to validate</param>
 	/// <returns>True if message contains "MF" marker and at least one "|" delimeter</returns>
-	static bool validate_packet(std::string const& input);
-
-private:
-	UDPReceiver(UDPReceiver const&) = delete;
-	UDPReceiver(UDPReceiver&&) = delete;
-	UDPReceiver& operator=(UDPReceiver const&) = delete;
-	UDPReceiver& operator=(UDPReceiver&&) = delete;
-
-	void setupMessageListener_();
+	static bool validate_packet(std::string_view input);
 
 	int message_port_;
 	std::string message_addr_;
 	bool multicast_enable_;
 	std::string multicast_out_addr_;
-	int message_socket_;
+	int receive_buffer_size_;
+	size_t receive_batch_size_;
+
+	// Id tables announced by senders using the dictionary wire format, keyed by session id
+	struct SenderDictionary
+	{
+		uint32_t pid;
+		time_t last_update;
+		std::unordered_map<uint16_t, std::string> strings;
+	};
+	static constexpr time_t DICTIONARY_EXPIRY_S = 3600;
+
+	struct Shard
+	{
+		Shard(size_t idx, size_t ring_size, size_t batch_size, size_t max_pending, size_t max_message_size,
+		      size_t max_pending_bytes, std::chrono::milliseconds fragment_timeout)
+		    : index(idx)
+		    // Each buffer holds the largest possible datagram; larger messages arrive as fragments
+		    , ring(ring_size, detail::MAX_UDP_PAYLOAD)
+		    , mmsg(batch_size)
+		    , iov(batch_size)
+		    , control(batch_size * CMSG_SPACE(sizeof(uint32_t)))
+		    , reassembler(max_pending, max_message_size, max_pending_bytes, fragment_timeout)
+		{}
+
+		size_t index;
+		int message_socket = -1;
+
+		// Datagrams travel from the receive thread to the parse thread through ring
+		detail::PacketRing ring;
+		std::mutex ring_mutex;
+		std::condition_variable ring_cv;
+		std::thread receive_thread;
+		std::thread parse_thread;  // Unused for the first shard, which run() parses itself
+		std::vector<struct mmsghdr> mmsg;
+		std::vector<struct iovec> iov;
+		std::vector<char> control;
+
+		std::atomic<size_t> packets_received{0};
+		std::atomic<size_t> ring_full_waits{0};
+		std::atomic<size_t> kernel_drops{0};  // Reported by SO_RXQ_OVFL, including sockets closed since
+		uint32_t socket_drops = 0;            // Last SO_RXQ_OVFL count of the current socket
+
+		// Counters read by statistics() from other threads are only touched with stats_mutex held
+		mutable std::mutex stats_mutex;
+		detail::SequenceTracker sequence_tracker;
+
+		// Reassembly of messages split into fragments by the sender
+		detail::FragmentReassembler reassembler;
+		std::chrono::steady_clock::time_point last_fragment_expire;
+		size_t next_incomplete_report = 1;
+
+		detail::TimestampDecoder timestamps;
 
-	std::list<std::string> tokenize_(std::string const& input);
+		std::unordered_map<uint64_t, SenderDictionary> dictionaries;
+		time_t last_dictionary_prune = 0;
+		std::atomic<size_t> unresolved_dictionary_msgs{0};  // Messages referring to ids not yet announced
+	};
+	std::vector<std::unique_ptr<Shard>> shards_;
 };
 }  // namespace mfviewer
 
@@ -0,0 +1,63 @@
+#ifndef mfextensions_Receivers_detail_BlockSequence_hh
+#define mfextensions_Receivers_detail_BlockSequence_hh
+
+#include <atomic>
+#include <cstddef>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Source of unique sequence numbers for several threads, handed out in blocks.
+///
+/// Each thread keeps a Block of its own (e.g. thread_local) and takes numbers from it without synchronization;
+/// only when the block is used up does it claim the next one from the shared counter. The numbers are unique,
+/// start at 1 and increase within each thread, so (together with a timestamp) they give a stable total order.
+/// Numbers from different threads are not ordered by the time they were taken.
+/// </summary>
+class BlockSequence
+{
+public:
+	/// <summary>
+	/// Per-thread state: the numbers left in the block this thread last claimed
+	/// </summary>
+	struct Block
+	{
+		size_t next = 0;  ///< Last number handed out
+		size_t end = 0;   ///< Last number in the block
+	};
+
+	/**
+	 * \brief BlockSequence Constructor
+	 * \param block_size Numbers claimed by a thread at a time
+	 */
+	explicit BlockSequence(size_t block_size)
+	    : block_size_(block_size > 0 ? block_size : 1), claimed_(0) {}
+
+	/**
+	 * \brief Take the next number for the calling thread
+	 * \param block The calling thread's Block, never shared with other threads
+	 * \return Sequence number
+	 */
+	size_t next(Block& block)
+	{
+		if (block.next == block.end)
+		{
+			block.next = claimed_.fetch_add(block_size_, std::memory_order_relaxed);
+			block.end = block.next + block_size_;
+		}
+		return ++block.next;
+	}
+
+	/// Numbers claimed by a thread at a time
+	size_t block_size() const { return block_size_; }
+
+private:
+	size_t block_size_;
+	alignas(64) std::atomic<size_t> claimed_;  // Numbers handed out in blocks so far
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_BlockSequence_hh
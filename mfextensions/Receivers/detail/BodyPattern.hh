@@ -0,0 +1,143 @@
+#ifndef mfextensions_Receivers_detail_BodyPattern_hh
+#define mfextensions_Receivers_detail_BodyPattern_hh
+
+#include <boost/regex.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace mfviewer {
+namespace detail {
+
+/**
+ * \brief Find a literal string in a text. With SSE2, 16 candidate positions are tested at once by comparing the
+ * first and last bytes of the needle, and only positions where both match are compared in full.
+ * \param text Text to look in
+ * \param needle String to look for
+ * \return Offset of the first occurrence of needle in text, or std::string_view::npos
+ */
+inline size_t find_literal(std::string_view text, std::string_view needle)
+{
+	if (needle.size() < 2 || needle.size() > text.size()) return text.find(needle);
+
+	size_t offset = 0;
+#ifdef __SSE2__
+	auto const k = needle.size();
+	auto const first = _mm_set1_epi8(needle.front());
+	auto const last = _mm_set1_epi8(needle.back());
+	for (; offset + k - 1 + 16 <= text.size(); offset += 16)
+	{
+		auto const* block = text.data() + offset;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto block_first = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block));           // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		auto block_last = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + k - 1));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+		for (; mask != 0; mask &= mask - 1)
+		{
+			auto bit = static_cast<size_t>(__builtin_ctz(mask));
+			if (std::memcmp(block + bit + 1, needle.data() + 1, k - 2) == 0) return offset + bit;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		}
+	}
+#endif
+	auto found = text.substr(offset).find(needle);
+	return found == std::string_view::npos ? found : offset + found;
+}
+
+/// <summary>
+/// Pattern over message bodies, for filter tabs. Patterns without regular expression metacharacters are matched
+/// as literals with find_literal; all others are compiled once as a Perl-style boost::regex, and matched anywhere
+/// in the body. A BodyPattern is immutable once made, so threads and tabs can share one.
+/// </summary>
+class BodyPattern
+{
+public:
+	/**
+	 * \brief BodyPattern Constructor
+	 * \param pattern Literal string or regular expression
+	 * \exception boost::regex_error if pattern is not a literal and not a valid regular expression
+	 */
+	explicit BodyPattern(std::string pattern)
+	    : pattern_(std::move(pattern)), literal_(is_literal(pattern_))
+	{
+		if (!literal_) regex_.assign(pattern_);
+	}
+
+	/// The pattern as given
+	std::string const& pattern() const { return pattern_; }
+
+	/// Whether the pattern is matched as a literal string
+	bool literal() const { return literal_; }
+
+	/// Whether a message body matches the pattern
+	bool matches(std::string_view body) const
+	{
+		if (literal_) return find_literal(body, pattern_) != std::string_view::npos;
+		return boost::regex_search(body.begin(), body.end(), regex_);
+	}
+
+	/**
+	 * \brief Whether a pattern has no regular expression metacharacters
+	 * \param pattern Pattern to check
+	 * \return True if the pattern only matches itself
+	 */
+	static bool is_literal(std::string_view pattern)
+	{
+		return pattern.find_first_of("\\^$.|?*+()[]{}") == std::string_view::npos;
+	}
+
+private:
+	std::string pattern_;
+	bool literal_;
+	boost::regex regex_;
+};
+
+/**
+ * \brief Select the candidates whose bodies match a pattern, splitting the candidates among threads
+ * \param pattern Pattern to match
+ * \param candidates Positions to check
+ * \param body_at Callable returning the body of the message at a position; called concurrently
+ * \param max_threads Most threads to use, or 0 for one per core. Each thread gets at least 4096 candidates.
+ * \return Matching positions, in the order of candidates
+ */
+template<typename Position, typename BodyAt>
+std::vector<Position> parallel_select(BodyPattern const& pattern, std::vector<Position> const& candidates, BodyAt&& body_at,
+                                      unsigned max_threads = 0)
+{
+	size_t constexpr min_per_thread = 4096;
+	size_t threads = max_threads != 0 ? max_threads : std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max(size_t{1}, std::min(threads, candidates.size() / min_per_thread));
+
+	// Each thread keeps its own matches, and they are joined in order
+	std::vector<std::vector<Position>> selected(threads);
+	auto work = [&](size_t part) {
+		auto begin = candidates.size() * part / threads;
+		auto end = candidates.size() * (part + 1) / threads;
+		for (auto ii = begin; ii < end; ++ii)
+		{
+			if (pattern.matches(body_at(candidates[ii]))) selected[part].push_back(candidates[ii]);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t part = 1; part < threads; ++part) workers.emplace_back(work, part);
+	work(0);
+	for (auto& worker : workers) worker.join();
+
+	std::vector<Position> result;
+	for (auto const& part : selected) result.insert(result.end(), part.begin(), part.end());
+	return result;
+}
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_BodyPattern_hh
@@ -0,0 +1,184 @@
+#ifndef mfextensions_Receivers_detail_FragmentReassembler_hh
+#define mfextensions_Receivers_detail_FragmentReassembler_hh
+
+#include "mfextensions/Receivers/detail/UDPWireFormat.hh"
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Reassembles payloads that ELUDP split into fragments (see UDPWireFormat.hh).
+///
+/// Partially received payloads are kept in a table bounded in number of entries, in total bytes and in age; payloads
+/// which are still incomplete when they time out or are evicted to make room are dropped and counted. A payload's
+/// buffer grows as its fragments arrive, so a first fragment claiming a large total length costs nothing until the
+/// data to fill it does.
+/// </summary>
+class FragmentReassembler
+{
+public:
+	/// Clock used for timeouts
+	using clock = std::chrono::steady_clock;
+
+	/// <summary>
+	/// Counters describing the reassembler's history
+	/// </summary>
+	struct Stats
+	{
+		size_t completed = 0;   ///< Payloads reassembled successfully
+		size_t incomplete = 0;  ///< Payloads dropped because fragments were missing when they timed out or were evicted
+		size_t rejected = 0;    ///< Fragments ignored because they were too large or inconsistent with earlier ones
+		size_t duplicates = 0;  ///< Fragments received more than once
+	};
+
+	/**
+	 * \brief FragmentReassembler Constructor
+	 * \param max_pending Maximum number of partially received payloads kept at once
+	 * \param max_message_size Largest payload accepted for reassembly, in bytes
+	 * \param max_pending_bytes Most bytes held for all partially received payloads together
+	 * \param timeout How long a partially received payload is kept after its first fragment arrived
+	 */
+	FragmentReassembler(size_t max_pending, size_t max_message_size, size_t max_pending_bytes, std::chrono::milliseconds timeout)
+	    : max_pending_(max_pending > 0 ? max_pending : 1), max_message_size_(max_message_size), max_pending_bytes_(max_pending_bytes), timeout_(timeout) {}
+
+	/**
+	 * \brief Add a fragment to the table
+	 * \param hdr Fragment header, as decoded by decode_fragment
+	 * \param data Fragment data
+	 * \param now Current time
+	 * \param[out] complete Set to the reassembled payload when this fragment completes it
+	 * \return True if the payload is now complete and has been moved into complete
+	 */
+	bool add(FragmentHeader const& hdr, std::string_view data, clock::time_point now, std::string& complete)
+	{
+		if (hdr.total_length > max_message_size_ || hdr.total_length > max_pending_bytes_)
+		{
+			++stats_.rejected;
+			return false;
+		}
+
+		auto key = std::make_pair(hdr.session, hdr.message_id);
+		auto it = pending_.find(key);
+		if (it == pending_.end())
+		{
+			if (pending_.size() >= max_pending_) evict_oldest_();
+
+			it = pending_.emplace(key, Pending()).first;
+			it->second.total_length = hdr.total_length;
+			it->second.received.resize(hdr.count, false);
+			it->second.first_seen = now;
+		}
+
+		auto& entry = it->second;
+		if (entry.total_length != hdr.total_length || entry.received.size() != hdr.count)
+		{
+			++stats_.rejected;
+			return false;
+		}
+		if (entry.received[hdr.index])
+		{
+			++stats_.duplicates;
+			return false;
+		}
+
+		// Grow the buffer to hold this fragment, dropping the oldest other payloads if that goes over budget
+		auto const end = static_cast<size_t>(hdr.offset) + data.size();
+		if (end > entry.data.size())
+		{
+			auto const growth = end - entry.data.size();
+			while (pending_bytes_ + growth > max_pending_bytes_ && evict_oldest_(&entry)) {}
+			entry.data.resize(end);
+			pending_bytes_ += growth;
+		}
+
+		entry.data.replace(hdr.offset, data.size(), data);
+		entry.received[hdr.index] = true;
+		if (++entry.received_count < hdr.count) return false;
+
+		pending_bytes_ -= entry.data.size();
+		complete = std::move(entry.data);
+		pending_.erase(it);
+		++stats_.completed;
+		return true;
+	}
+
+	/**
+	 * \brief Drop partially received payloads older than the timeout
+	 * \param now Current time
+	 * \return Number of payloads dropped
+	 */
+	size_t expire(clock::time_point now)
+	{
+		size_t dropped = 0;
+		for (auto it = pending_.begin(); it != pending_.end();)
+		{
+			if (now - it->second.first_seen > timeout_)
+			{
+				pending_bytes_ -= it->second.data.size();
+				it = pending_.erase(it);
+				++dropped;
+			}
+			else
+			{
+				++it;
+			}
+		}
+		stats_.incomplete += dropped;
+		return dropped;
+	}
+
+	/// Number of partially received payloads currently held
+	size_t pending() const { return pending_.size(); }
+
+	/// Bytes currently held for partially received payloads
+	size_t pending_bytes() const { return pending_bytes_; }
+
+	/// Counters describing the reassembler's history
+	Stats const& stats() const { return stats_; }
+
+private:
+	struct Pending
+	{
+		uint32_t total_length = 0;
+		std::string data;  // received so far, up to the end of the furthest fragment
+		std::vector<bool> received;
+		uint16_t received_count = 0;
+		clock::time_point first_seen;
+	};
+
+	// Drop the oldest payload other than keep; returns false if there is none
+	bool evict_oldest_(Pending const* keep = nullptr)
+	{
+		auto oldest = pending_.end();
+		for (auto it = pending_.begin(); it != pending_.end(); ++it)
+		{
+			if (&it->second == keep) continue;
+			if (oldest == pending_.end() || it->second.first_seen < oldest->second.first_seen) oldest = it;
+		}
+		if (oldest == pending_.end()) return false;
+
+		pending_bytes_ -= oldest->second.data.size();
+		pending_.erase(oldest);
+		++stats_.incomplete;
+		return true;
+	}
+
+	size_t max_pending_;
+	size_t max_message_size_;
+	size_t max_pending_bytes_;
+	size_t pending_bytes_ = 0;
+	clock::duration timeout_;
+	std::map<std::pair<uint64_t, uint32_t>, Pending> pending_;
+	Stats stats_;
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_FragmentReassembler_hh
@@ -0,0 +1,130 @@
+#ifndef mfextensions_Receivers_detail_InternTable_hh
+#define mfextensions_Receivers_detail_InternTable_hh
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Table of interned strings, each stored once together with a value derived from it (e.g. its QString form).
+///
+/// intern() returns a small integer handle, the same one every time for the same string, so that code holding
+/// handles can compare strings, and key maps on them, with integer operations. Interning takes a lock; looking up
+/// the string or value of a handle does not, and may be done from any thread which received the handle. Entries
+/// are never removed, so the table is meant for fields with few distinct values (hosts, categories, ...).
+/// </summary>
+template<typename T>
+class InternTable
+{
+public:
+	typedef uint32_t id_t;  ///< Handle to an interned string
+
+	static constexpr size_t chunk_size = 1024;  ///< Entries allocated at a time
+	static constexpr size_t max_chunks = 4096;  ///< Limit on the number of entries, in chunks
+
+	InternTable()
+	    : size_(0)
+	{
+		for (auto& chunk : chunks_) chunk.store(nullptr, std::memory_order_relaxed);
+	}
+
+	~InternTable()
+	{
+		for (auto& chunk : chunks_) delete[] chunk.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * \brief Get the handle of a string, adding it to the table if it is new
+	 * \param key String to intern
+	 * \param make Called as make(std::string const&) to create the value of a new entry
+	 * \return Handle of the string
+	 * \exception std::length_error if the table is full
+	 */
+	template<typename Make>
+	id_t intern(std::string_view key, Make const& make)
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		auto it = index_.find(key);
+		if (it != index_.end()) return it->second;
+
+		auto id = size_.load(std::memory_order_relaxed);
+		if (id >= chunk_size * max_chunks) throw std::length_error("InternTable is full");
+
+		auto& slot = chunks_[id / chunk_size];  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+		auto chunk = slot.load(std::memory_order_relaxed);
+		if (chunk == nullptr)
+		{
+			chunk = new Entry[chunk_size];
+			slot.store(chunk, std::memory_order_release);
+		}
+
+		auto& entry = chunk[id % chunk_size];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		entry.key.assign(key.data(), key.size());
+		entry.value = make(entry.key);
+		index_.emplace(std::string_view(entry.key), static_cast<id_t>(id));
+		size_.store(id + 1, std::memory_order_release);
+		return static_cast<id_t>(id);
+	}
+
+	/**
+	 * \brief Look up the handle of a string without adding it
+	 * \param key String to look for
+	 * \param[out] id Set to the handle of the string, if found
+	 * \return False if the string has not been interned
+	 */
+	bool find(std::string_view key, id_t& id) const
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		auto it = index_.find(key);
+		if (it == index_.end()) return false;
+		id = it->second;
+		return true;
+	}
+
+	/// The interned string; id must have been returned by intern()
+	std::string const& key(id_t id) const { return entry_(id).key; }
+
+	/// The value made for the interned string; id must have been returned by intern()
+	T const& operator[](id_t id) const { return entry_(id).value; }
+
+	/// Number of strings interned
+	size_t size() const { return size_.load(std::memory_order_acquire); }
+
+private:
+	InternTable(InternTable const&) = delete;
+	InternTable(InternTable&&) = delete;
+	InternTable& operator=(InternTable const&) = delete;
+	InternTable& operator=(InternTable&&) = delete;
+
+	struct Entry
+	{
+		std::string key;
+		T value;
+	};
+
+	Entry const& entry_(id_t id) const
+	{
+		// Entries never move, so no lock is needed once the handle has been handed out
+		return chunks_[id / chunk_size].load(std::memory_order_acquire)[id % chunk_size];  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+	mutable std::mutex mutex_;
+	std::unordered_map<std::string_view, id_t> index_;
+	std::array<std::atomic<Entry*>, max_chunks> chunks_;
+	std::atomic<size_t> size_;
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_InternTable_hh
@@ -0,0 +1,109 @@
+#ifndef mfextensions_Receivers_detail_MessageRing_hh
+#define mfextensions_Receivers_detail_MessageRing_hh
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// First-in, first-out store of messages in a ring of slots.
+///
+/// Every message gets a position: the number of messages stored before it. Positions are never reused, so they
+/// work as generation counters: a position names the same message for as long as it is stored, and contains()
+/// tells whether that message has since been evicted. Adding a message and evicting the oldest are O(1); the
+/// ring only allocates when it holds more messages than ever before.
+/// </summary>
+template<typename T>
+class MessageRing
+{
+public:
+	typedef uint64_t position_t;  ///< Position of a message in the stream of stored messages
+
+	/**
+	 * \brief MessageRing Constructor
+	 * \param capacity Number of messages to make room for up front
+	 */
+	explicit MessageRing(size_t capacity = 0)
+	    : slots_(capacity), begin_(0), end_(0) {}
+
+	/// Number of messages stored
+	size_t size() const { return static_cast<size_t>(end_ - begin_); }
+
+	/// Whether no messages are stored
+	bool empty() const { return begin_ == end_; }
+
+	/// Position of the oldest message stored
+	position_t begin() const { return begin_; }
+
+	/// Position the next message will get
+	position_t end() const { return end_; }
+
+	/// Whether the message at a position is still stored
+	bool contains(position_t position) const { return position >= begin_ && position < end_; }
+
+	/// The message at a position; contains(position) must be true
+	T const& operator[](position_t position) const { return slots_[slot_(position)]; }
+
+	/// The oldest message; the ring must not be empty
+	T const& front() const { return (*this)[begin_]; }
+
+	/**
+	 * \brief Make room for a number of messages without further allocation
+	 * \param capacity Number of messages
+	 */
+	void reserve(size_t capacity)
+	{
+		if (capacity > slots_.size()) resize_(capacity);
+	}
+
+	/**
+	 * \brief Store a message as the newest one
+	 * \param value Message to store
+	 * \return Position of the message
+	 */
+	position_t push_back(T value)
+	{
+		if (size() == slots_.size()) resize_(slots_.empty() ? 16 : 2 * slots_.size());
+		slots_[slot_(end_)] = std::move(value);
+		return end_++;
+	}
+
+	/// Evict the oldest message; the ring must not be empty
+	void pop_front()
+	{
+		slots_[slot_(begin_)] = T();  // do not keep what the message owns alive in the ring
+		++begin_;
+	}
+
+	/// Evict all messages. Positions keep counting up, so old positions stay invalid.
+	void clear()
+	{
+		while (!empty()) pop_front();
+	}
+
+private:
+	size_t slot_(position_t position) const { return static_cast<size_t>(position % slots_.size()); }
+
+	void resize_(size_t capacity)
+	{
+		std::vector<T> slots(capacity);
+		for (auto position = begin_; position != end_; ++position)
+		{
+			slots[static_cast<size_t>(position % capacity)] = std::move(slots_[slot_(position)]);
+		}
+		slots_.swap(slots);
+	}
+
+	std::vector<T> slots_;
+	position_t begin_;
+	position_t end_;
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_MessageRing_hh
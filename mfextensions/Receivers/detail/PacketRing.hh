@@ -0,0 +1,85 @@
+#ifndef mfextensions_Receivers_detail_PacketRing_hh
+#define mfextensions_Receivers_detail_PacketRing_hh
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Fixed ring of reusable datagram buffers, handed from one producer thread (which fills them from the socket) to
+/// one consumer thread (which parses them) without locking or copying.
+///
+/// The producer fills write_slot(0..free_slots()-1) and then publish()es them; the consumer reads
+/// read_slot(0..ready()-1) and then release()s them. Neither call blocks; waiting, if any, is up to the caller.
+/// </summary>
+class PacketRing
+{
+public:
+	/// <summary>
+	/// One datagram buffer
+	/// </summary>
+	struct Slot
+	{
+		std::vector<char> data;  ///< Buffer, sized at construction
+		size_t size = 0;         ///< Number of bytes of data in use
+	};
+
+	/**
+	 * \brief PacketRing Constructor
+	 * \param slot_count Number of buffers in the ring
+	 * \param slot_size Size of each buffer, in bytes
+	 */
+	PacketRing(size_t slot_count, size_t slot_size)
+	    : slots_(slot_count > 0 ? slot_count : 1), head_(0), tail_(0)
+	{
+		for (auto& slot : slots_) slot.data.resize(slot_size);
+	}
+
+	/// Number of buffers in the ring
+	size_t capacity() const { return slots_.size(); }
+
+	/// (Producer) Number of buffers which may be filled before the next publish
+	size_t free_slots() const { return slots_.size() - (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire)); }
+
+	/**
+	 * \brief (Producer) Access a buffer which is not yet published
+	 * \param ii Index after the last published buffer, less than free_slots()
+	 * \return Buffer to fill
+	 */
+	Slot& write_slot(size_t ii) { return slots_[(head_.load(std::memory_order_relaxed) + ii) % slots_.size()]; }
+
+	/**
+	 * \brief (Producer) Hand filled buffers to the consumer
+	 * \param count Number of buffers, starting at write_slot(0), to publish
+	 */
+	void publish(size_t count) { head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+
+	/// (Consumer) Number of published buffers waiting to be read
+	size_t ready() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed); }
+
+	/**
+	 * \brief (Consumer) Access a published buffer
+	 * \param ii Index from the oldest unread buffer, less than ready()
+	 * \return Buffer to read
+	 */
+	Slot const& read_slot(size_t ii) const { return slots_[(tail_.load(std::memory_order_relaxed) + ii) % slots_.size()]; }
+
+	/**
+	 * \brief (Consumer) Return read buffers to the producer
+	 * \param count Number of buffers, starting at read_slot(0), to release
+	 */
+	void release(size_t count) { tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release); }
+
+private:
+	std::vector<Slot> slots_;
+	alignas(64) std::atomic<size_t> head_;  // Total buffers published; written by the producer only
+	alignas(64) std::atomic<size_t> tail_;  // Total buffers released; written by the consumer only
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_PacketRing_hh
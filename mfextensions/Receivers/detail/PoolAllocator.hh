@@ -0,0 +1,216 @@
+#ifndef mfextensions_Receivers_detail_PoolAllocator_hh
+#define mfextensions_Receivers_detail_PoolAllocator_hh
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Pool of fixed-size blocks, carved out of large slabs and recycled through a free list.
+///
+/// Blocks are never returned to the system: a pool grows to the largest number of blocks in use at once and then
+/// stays that size, however the blocks are allocated and freed, instead of fragmenting the heap. Blocks may be
+/// allocated and freed from any thread.
+/// </summary>
+class SlabPool
+{
+public:
+	/**
+	 * \brief SlabPool Constructor
+	 * \param block_size Size of each block, rounded up to a multiple of alignof(std::max_align_t)
+	 * \param slab_bytes Approximate size of the slabs the blocks are carved from
+	 */
+	SlabPool(size_t block_size, size_t slab_bytes = 64 * 1024)
+	    : block_units_((std::max(block_size, sizeof(FreeBlock)) + sizeof(unit_t) - 1) / sizeof(unit_t))
+	    , blocks_per_slab_(std::max(size_t{1}, slab_bytes / (block_units_ * sizeof(unit_t))))
+	    , free_(nullptr)
+	    , capacity_(0)
+	    , in_use_(0) {}
+
+	/// Size of each block
+	size_t block_size() const { return block_units_ * sizeof(unit_t); }
+
+	/// Number of blocks carved out so far
+	size_t capacity() const
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		return capacity_;
+	}
+
+	/// Number of blocks allocated and not yet freed
+	size_t in_use() const
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		return in_use_;
+	}
+
+	/// Take a block
+	void* allocate()
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		if (free_ == nullptr) add_slab_();
+		auto block = free_;
+		free_ = block->next;
+		++in_use_;
+		return block;
+	}
+
+	/// Give back a block taken with allocate()
+	void deallocate(void* p) noexcept
+	{
+		auto block = static_cast<FreeBlock*>(p);
+		std::lock_guard<std::mutex> lk(mutex_);
+		block->next = free_;
+		free_ = block;
+		--in_use_;
+	}
+
+	/**
+	 * \brief Carve out slabs ahead of time, so that allocating up to the given number of blocks does not allocate memory
+	 * \param blocks Number of blocks the pool should hold
+	 */
+	void reserve(size_t blocks)
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		while (capacity_ < blocks) add_slab_();
+	}
+
+private:
+	SlabPool(SlabPool const&) = delete;
+	SlabPool(SlabPool&&) = delete;
+	SlabPool& operator=(SlabPool const&) = delete;
+	SlabPool& operator=(SlabPool&&) = delete;
+
+	typedef std::max_align_t unit_t;
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	// Called with mutex_ held
+	void add_slab_()
+	{
+		slabs_.emplace_back(new unit_t[block_units_ * blocks_per_slab_]);
+		auto slab = slabs_.back().get();
+		for (size_t i = blocks_per_slab_; i > 0; --i)
+		{
+			auto block = new (slab + (i - 1) * block_units_) FreeBlock;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			block->next = free_;
+			free_ = block;
+		}
+		capacity_ += blocks_per_slab_;
+	}
+
+	size_t block_units_;
+	size_t blocks_per_slab_;
+	mutable std::mutex mutex_;
+	FreeBlock* free_;
+	std::vector<std::unique_ptr<unit_t[]>> slabs_;
+	size_t capacity_;
+	size_t in_use_;
+};
+
+/// <summary>
+/// The shared SlabPools behind PoolAllocator, one per size class up to max_size bytes. Sizes grow by about half
+/// from one class to the next, which bounds the space wasted by rounding up.
+/// </summary>
+class SizeClassPools
+{
+public:
+	static constexpr size_t max_size = 4096;  ///< Larger allocations go to the heap
+
+	/// The pool for allocations of the given size, or nullptr if they are too large to pool
+	static SlabPool* pool_for(size_t bytes)
+	{
+		static constexpr std::array<size_t, 15> sizes{{32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, max_size}};
+		static std::array<std::unique_ptr<SlabPool>, sizes.size()> const pools = [] {
+			std::array<std::unique_ptr<SlabPool>, sizes.size()> pools;
+			for (size_t i = 0; i < sizes.size(); ++i) pools[i] = std::make_unique<SlabPool>(sizes[i]);  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+			return pools;
+		}();
+
+		for (size_t i = 0; i < sizes.size(); ++i)
+		{
+			if (bytes <= sizes[i]) return pools[i].get();  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+		}
+		return nullptr;
+	}
+};
+
+/// <summary>
+/// Stateless standard allocator which serves allocations of up to SizeClassPools::max_size bytes from the shared
+/// size-class pools, and larger ones from the heap. Suitable for std::allocate_shared and for containers and
+/// strings holding long-lived data.
+/// </summary>
+template<typename T>
+class PoolAllocator
+{
+public:
+	typedef T value_type;  ///< Type allocated
+
+	static_assert(alignof(T) <= alignof(std::max_align_t), "PoolAllocator does not support over-aligned types");
+
+	PoolAllocator() noexcept = default;
+
+	/// Rebinding constructor
+	template<typename U>
+	PoolAllocator(PoolAllocator<U> const&) noexcept  // NOLINT(google-explicit-constructor)
+	{}
+
+	/**
+	 * \brief Allocate memory for n objects of type T
+	 * \param n Number of objects
+	 * \return Uninitialized memory
+	 */
+	T* allocate(size_t n)
+	{
+		auto pool = SizeClassPools::pool_for(n * sizeof(T));
+		return static_cast<T*>(pool != nullptr ? pool->allocate() : ::operator new(n * sizeof(T)));
+	}
+
+	/**
+	 * \brief Free memory from allocate()
+	 * \param p Memory to free
+	 * \param n Number of objects it was allocated for
+	 */
+	void deallocate(T* p, size_t n) noexcept
+	{
+		auto pool = SizeClassPools::pool_for(n * sizeof(T));
+		if (pool != nullptr)
+			pool->deallocate(p);
+		else
+			::operator delete(p);
+	}
+};
+
+/// All PoolAllocators share the same pools
+template<typename T, typename U>
+bool operator==(PoolAllocator<T> const&, PoolAllocator<U> const&) noexcept
+{
+	return true;
+}
+
+/// All PoolAllocators share the same pools
+template<typename T, typename U>
+bool operator!=(PoolAllocator<T> const&, PoolAllocator<U> const&) noexcept
+{
+	return false;
+}
+
+/// <summary>
+/// A string whose buffer, if too long for the string itself, comes from the size-class pools
+/// </summary>
+typedef std::basic_string<char, std::char_traits<char>, PoolAllocator<char>> pooled_string;
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_PoolAllocator_hh
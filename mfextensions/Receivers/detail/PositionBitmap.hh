@@ -0,0 +1,237 @@
+#ifndef mfextensions_Receivers_detail_PositionBitmap_hh
+#define mfextensions_Receivers_detail_PositionBitmap_hh
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Compressed set of MessageRing positions, in the style of a roaring bitmap.
+///
+/// Positions are grouped in chunks of 65536. A chunk holding few positions keeps them as a sorted array of
+/// 16-bit offsets; once it holds more than array_max it switches to a plain bitmap of 1024 words. Positions are
+/// added in increasing order, and whole chunks are dropped once the ring has evicted everything in them.
+/// </summary>
+class PositionBitmap
+{
+public:
+	typedef uint64_t position_t;  ///< Position in a MessageRing
+
+	static constexpr unsigned chunk_shift = 16;                 ///< log2 of the positions per chunk
+	static constexpr size_t chunk_words = (1 << chunk_shift) / 64;  ///< Words in a chunk's bitmap
+	static constexpr size_t array_max = 4096;                  ///< Most positions a chunk keeps as an array
+
+	/**
+	 * \brief Add a position
+	 * \param position Position to add; must not be smaller than any added before
+	 */
+	void add(position_t position)
+	{
+		auto high = position >> chunk_shift;
+		auto low = static_cast<uint16_t>(position);
+		if (chunks_.empty() || chunks_.back().high != high)
+		{
+			chunks_.emplace_back();
+			chunks_.back().high = high;
+		}
+
+		auto& chunk = chunks_.back();
+		if (!chunk.bits.empty())
+		{
+			chunk.bits[low / 64] |= uint64_t{1} << (low % 64);  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+			return;
+		}
+		if (!chunk.array.empty() && chunk.array.back() == low) return;
+		chunk.array.push_back(low);
+		if (chunk.array.size() > array_max)
+		{
+			chunk.bits.assign(chunk_words, 0);
+			for (auto offset : chunk.array) chunk.bits[offset / 64] |= uint64_t{1} << (offset % 64);
+			chunk.array.clear();
+			chunk.array.shrink_to_fit();
+		}
+	}
+
+	/**
+	 * \brief Drop the chunks holding only positions before the given one. Positions before it in the remaining
+	 * chunk are kept, so queries must still be limited to the range of stored positions.
+	 * \param position Oldest position still of interest
+	 */
+	void drop_before(position_t position)
+	{
+		auto high = position >> chunk_shift;
+		while (!chunks_.empty() && chunks_.front().high < high) chunks_.pop_front();
+	}
+
+	/// Whether no chunks are held
+	bool empty() const { return chunks_.empty(); }
+
+	/// Whether a position has been added (and not dropped)
+	bool contains(position_t position) const
+	{
+		auto chunk = find_(position >> chunk_shift);
+		if (chunk == nullptr) return false;
+		auto low = static_cast<uint16_t>(position);
+		if (!chunk->bits.empty()) return (chunk->bits[low / 64] >> (low % 64)) & 1;  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+		return std::binary_search(chunk->array.begin(), chunk->array.end(), low);
+	}
+
+	/**
+	 * \brief OR the positions in one chunk into a bitmap
+	 * \param high Chunk number (position >> chunk_shift)
+	 * \param[in,out] words Bitmap of chunk_words words
+	 */
+	void or_into(position_t high, uint64_t* words) const
+	{
+		auto chunk = find_(high);
+		if (chunk == nullptr) return;
+		if (!chunk->bits.empty())
+		{
+			for (size_t i = 0; i < chunk_words; ++i) words[i] |= chunk->bits[i];  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+			return;
+		}
+		for (auto offset : chunk->array) words[offset / 64] |= uint64_t{1} << (offset % 64);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	}
+
+private:
+	struct Chunk
+	{
+		position_t high = 0;          // Chunk number
+		std::vector<uint16_t> array;  // Sorted offsets, while the chunk is sparse
+		std::vector<uint64_t> bits;   // Bitmap, once it is not
+	};
+
+	Chunk const* find_(position_t high) const
+	{
+		auto it = std::lower_bound(chunks_.begin(), chunks_.end(), high, [](Chunk const& chunk, position_t h) { return chunk.high < h; });
+		return it == chunks_.end() || it->high != high ? nullptr : &*it;
+	}
+
+	std::deque<Chunk> chunks_;
+};
+
+/**
+ * \brief Select the positions in [begin, end) which are, for every non-empty group, in at least one of the group's
+ * bitmaps: an AND of ORs, evaluated a chunk at a time with word operations
+ * \param groups Groups of bitmaps; nullptr entries match nothing, and empty groups are ignored
+ * \param begin First position to consider
+ * \param end Position after the last one to consider
+ * \return Selected positions, in increasing order
+ */
+inline std::vector<PositionBitmap::position_t> select_positions(std::vector<std::vector<PositionBitmap const*>> const& groups,
+                                                                 PositionBitmap::position_t begin, PositionBitmap::position_t end)
+{
+	std::vector<PositionBitmap::position_t> selected;
+	if (begin >= end) return selected;
+
+	std::vector<uint64_t> result(PositionBitmap::chunk_words);
+	std::vector<uint64_t> group_words(PositionBitmap::chunk_words);
+	for (auto high = begin >> PositionBitmap::chunk_shift; high <= (end - 1) >> PositionBitmap::chunk_shift; ++high)
+	{
+		std::fill(result.begin(), result.end(), ~uint64_t{0});
+		for (auto const& group : groups)
+		{
+			if (group.empty()) continue;
+			std::fill(group_words.begin(), group_words.end(), 0);
+			for (auto bitmap : group)
+			{
+				if (bitmap != nullptr) bitmap->or_into(high, group_words.data());
+			}
+			for (size_t i = 0; i < result.size(); ++i) result[i] &= group_words[i];
+		}
+
+		auto base = high << PositionBitmap::chunk_shift;
+		for (size_t i = 0; i < result.size(); ++i)
+		{
+			for (auto word = result[i]; word != 0; word &= word - 1)
+			{
+				auto position = base + i * 64 + static_cast<unsigned>(__builtin_ctzll(word));
+				if (position >= begin && position < end) selected.push_back(position);
+			}
+		}
+	}
+	return selected;
+}
+
+/// <summary>
+/// Index from a key (e.g. an interned host name) to the positions, in a MessageRing, of the messages having it.
+///
+/// Positions are added in increasing order and evicted oldest first, like the ring itself, so evicting a message
+/// only has to update its key's count and drop chunks the ring has left behind.
+/// </summary>
+template<typename Key>
+class BitmapIndex
+{
+public:
+	typedef PositionBitmap::position_t position_t;  ///< Position in a MessageRing
+
+	/// <summary>
+	/// The messages having a key
+	/// </summary>
+	struct Entry
+	{
+		PositionBitmap positions;  ///< Their positions
+		size_t count = 0;          ///< How many times they were added, less evictions
+	};
+	typedef std::unordered_map<Key, Entry> map_t;  ///< Key to positions
+
+	/**
+	 * \brief Record that the message at a position has a key. A message may be added with the same key more than
+	 * once, as long as it is evicted with it as many times.
+	 * \param key Key of the message
+	 * \param position Position of the message; must not be smaller than any added before
+	 * \return True if the key is new to the index
+	 */
+	bool add(Key const& key, position_t position)
+	{
+		auto& entry = map_[key];
+		entry.positions.add(position);
+		return ++entry.count == 1;
+	}
+
+	/**
+	 * \brief Forget the message at a position, which must be the oldest in the ring
+	 * \param key Key of the message
+	 * \param position Position of the message
+	 * \return True if no other message has the key, which has been removed from the index
+	 */
+	bool evict(Key const& key, position_t position)
+	{
+		auto it = map_.find(key);
+		if (it == map_.end()) return false;
+		if (--it->second.count > 0)
+		{
+			it->second.positions.drop_before(position + 1);
+			return false;
+		}
+		map_.erase(it);
+		return true;
+	}
+
+	/// The positions of the messages having a key, or nullptr if none do
+	PositionBitmap const* find(Key const& key) const
+	{
+		auto it = map_.find(key);
+		return it == map_.end() ? nullptr : &it->second.positions;
+	}
+
+	/// All keys with their positions
+	map_t const& map() const { return map_; }
+
+	/// Forget all keys
+	void clear() { map_.clear(); }
+
+private:
+	map_t map_;
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_PositionBitmap_hh
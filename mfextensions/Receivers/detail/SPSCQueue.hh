@@ -0,0 +1,74 @@
+#ifndef mfextensions_Receivers_detail_SPSCQueue_hh
+#define mfextensions_Receivers_detail_SPSCQueue_hh
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Bounded queue handing values from one producer thread to one consumer thread without locking.
+///
+/// Like PacketRing, each side owns one index and only reads the other's; neither call blocks, and waiting for
+/// space or for values, if any, is up to the caller. Several producers may share a queue if they serialize their
+/// pushes themselves (e.g. with a mutex).
+/// </summary>
+template<typename T>
+class SPSCQueue
+{
+public:
+	/**
+	 * \brief SPSCQueue Constructor
+	 * \param capacity Maximum number of values held at once
+	 */
+	explicit SPSCQueue(size_t capacity)
+	    : values_(capacity > 0 ? capacity : 1), head_(0), tail_(0) {}
+
+	/// Maximum number of values held at once
+	size_t capacity() const { return values_.size(); }
+
+	/// Number of values waiting; exact only when called from the producer or the consumer with the other idle
+	size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+
+	/**
+	 * \brief (Producer) Append a value, if there is room
+	 * \param value Value to append; moved from only on success
+	 * \return False if the queue is full
+	 */
+	bool try_push(T& value)
+	{
+		auto head = head_.load(std::memory_order_relaxed);
+		if (head - tail_.load(std::memory_order_acquire) >= values_.size()) return false;
+		values_[head % values_.size()] = std::move(value);
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * \brief (Consumer) Remove the oldest value, if any
+	 * \param[out] value Set to the removed value
+	 * \return False if the queue is empty
+	 */
+	bool try_pop(T& value)
+	{
+		auto tail = tail_.load(std::memory_order_relaxed);
+		if (head_.load(std::memory_order_acquire) == tail) return false;
+		value = std::move(values_[tail % values_.size()]);
+		values_[tail % values_.size()] = T();  // do not keep what the value owns alive in the queue
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::vector<T> values_;
+	alignas(64) std::atomic<size_t> head_;  // Total values pushed; written by the producer only
+	alignas(64) std::atomic<size_t> tail_;  // Total values popped; written by the consumer only
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_SPSCQueue_hh
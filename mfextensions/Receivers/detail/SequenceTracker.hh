@@ -0,0 +1,113 @@
+#ifndef mfextensions_Receivers_detail_SequenceTracker_hh
+#define mfextensions_Receivers_detail_SequenceTracker_hh
+
+#include <bitset>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Follows the sequence numbers ELUDP stamps on its messages, per sending (host, pid, session), and counts the ones
+/// that never arrived, arrived twice or arrived out of order. Only the dictionary wire format carries the sender's
+/// session id; other messages are tracked with session 0.
+///
+/// A window of recently seen sequence numbers below the highest one lets a late message be told apart from a
+/// duplicate: a late arrival fills a gap that had been counted as missing. The sender is taken to have started
+/// counting again (e.g. its destination was re-created in the same process) when a number further back than the
+/// window arrives, or when a number already received arrives again and is closer to the start of the count than to
+/// the highest number seen; duplicates made by the network arrive close behind the original.
+/// </summary>
+class SequenceTracker
+{
+public:
+	/// Number of sequence numbers below the highest seen that are remembered per sender
+	static constexpr int64_t WINDOW = 1024;
+
+	/// <summary>
+	/// Totals over all senders
+	/// </summary>
+	struct Stats
+	{
+		size_t received = 0;    ///< Messages with a sequence number
+		size_t missing = 0;     ///< Sequence numbers skipped and not (yet) received late
+		size_t duplicates = 0;  ///< Messages whose sequence number had already been received
+		size_t reordered = 0;   ///< Messages received after one with a higher sequence number
+		size_t resets = 0;      ///< Times a sender's sequence numbers started again
+		size_t senders = 0;     ///< Distinct (host, pid, session) triples seen
+	};
+
+	/**
+	 * \brief Account for a received message
+	 * \param host Sender's host name
+	 * \param pid Sender's process ID
+	 * \param seqNum Message sequence number
+	 * \param session Sender's session id, or 0 if the message does not carry one
+	 */
+	void record(std::string const& host, int64_t pid, int64_t seqNum, uint64_t session = 0)
+	{
+		++stats_.received;
+
+		auto key = std::make_tuple(host, pid, session);
+		auto it = senders_.find(key);
+		if (it == senders_.end())
+		{
+			auto& sender = senders_[key];
+			sender.last = seqNum;
+			sender.seen.set(0);
+			stats_.senders = senders_.size();
+			return;
+		}
+
+		auto& sender = it->second;
+		auto distance = seqNum - sender.last;
+		if (distance > 0)
+		{
+			stats_.missing += distance - 1;
+			sender.seen = distance < WINDOW ? sender.seen << distance : std::bitset<WINDOW>();
+			sender.seen.set(0);
+			sender.last = seqNum;
+		}
+		else if (-distance < WINDOW && !(sender.seen.test(-distance) && seqNum < -distance))
+		{
+			if (sender.seen.test(-distance))
+			{
+				++stats_.duplicates;
+			}
+			else
+			{
+				sender.seen.set(-distance);
+				++stats_.reordered;
+				if (stats_.missing > 0) --stats_.missing;
+			}
+		}
+		else
+		{
+			++stats_.resets;
+			sender.seen.reset();
+			sender.seen.set(0);
+			sender.last = seqNum;
+		}
+	}
+
+	/// Totals over all senders
+	Stats const& stats() const { return stats_; }
+
+private:
+	struct Sender
+	{
+		int64_t last = 0;          ///< Highest sequence number received
+		std::bitset<WINDOW> seen;  ///< Bit N set if (last - N) was received
+	};
+
+	std::map<std::tuple<std::string, int64_t, uint64_t>, Sender> senders_;
+	Stats stats_;
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_SequenceTracker_hh
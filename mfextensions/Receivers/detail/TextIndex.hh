@@ -0,0 +1,128 @@
+#ifndef mfextensions_Receivers_detail_TextIndex_hh
+#define mfextensions_Receivers_detail_TextIndex_hh
+
+#include "mfextensions/Receivers/detail/PositionBitmap.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Trigram index over message text, for substring search of a MessageRing.
+///
+/// Every three-byte sequence of a message's text maps to the positions of the messages containing it. A
+/// query is answered by intersecting the bitmaps of its own trigrams and checking the few candidates left against
+/// their text. Matching ignores ASCII case, like the viewer's text search always has.
+/// </summary>
+class TextIndex
+{
+public:
+	typedef PositionBitmap::position_t position_t;  ///< Position in a MessageRing
+
+	/**
+	 * \brief Index the text of a message
+	 * \param text Text of the message
+	 * \param position Position of the message; must be larger than any added before
+	 */
+	void add(std::string_view text, position_t position)
+	{
+		for (auto gram : grams_(text)) index_.add(gram, position);
+	}
+
+	/**
+	 * \brief Forget the message at a position, which must be the oldest in the ring
+	 * \param text Text the message was added with
+	 * \param position Position of the message
+	 */
+	void evict(std::string_view text, position_t position)
+	{
+		for (auto gram : grams_(text)) index_.evict(gram, position);
+	}
+
+	/**
+	 * \brief Find the messages whose text contains a string
+	 * \param query String to look for
+	 * \param begin Position of the oldest message to consider
+	 * \param end Position after the newest message to consider
+	 * \param text_at Callable returning the text of the message at a position
+	 * \return Positions of the matching messages, in increasing order
+	 */
+	template<typename TextAt>
+	std::vector<position_t> search(std::string_view query, position_t begin, position_t end, TextAt&& text_at) const
+	{
+		std::vector<position_t> candidates;
+		if (query.size() < gram_size)
+		{
+			// Too short to have a trigram: check every message
+			for (auto position = begin; position < end; ++position) candidates.push_back(position);
+		}
+		else
+		{
+			auto grams = grams_(query);
+			std::sort(grams.begin(), grams.end());
+			grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+			std::vector<std::vector<PositionBitmap const*>> groups;
+			for (auto gram : grams) groups.push_back({index_.find(gram)});
+			candidates = select_positions(groups, begin, end);
+		}
+
+		std::vector<position_t> matches;
+		for (auto position : candidates)
+		{
+			if (contains(text_at(position), query)) matches.push_back(position);
+		}
+		return matches;
+	}
+
+	/**
+	 * \brief Whether a text contains a string, ignoring ASCII case
+	 * \param text Text to look in
+	 * \param query String to look for
+	 * \return True if query occurs in text
+	 */
+	static bool contains(std::string_view text, std::string_view query)
+	{
+		return std::search(text.begin(), text.end(), query.begin(), query.end(),
+		                   [](char a, char b) { return fold_(a) == fold_(b); }) != text.end();
+	}
+
+	/// Number of distinct trigrams indexed
+	size_t size() const { return index_.map().size(); }
+
+	/// Forget all messages
+	void clear() { index_.clear(); }
+
+	static constexpr size_t gram_size = 3;  ///< Length of the indexed substrings
+
+private:
+	static char fold_(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+	// Trigrams of a text, each packed into the low bytes of a word. Repeats are left in: adding a message's
+	// position to a bitmap again is cheaper than sorting them out, and evict() sees the same repeats.
+	static std::vector<uint32_t> grams_(std::string_view text)
+	{
+		std::vector<uint32_t> grams;
+		if (text.size() < gram_size) return grams;
+		grams.reserve(text.size() - gram_size + 1);
+		uint32_t gram = 0;
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			gram = ((gram << 8) | static_cast<unsigned char>(fold_(text[i]))) & 0xFFFFFF;
+			if (i + 1 >= gram_size) grams.push_back(gram);
+		}
+		return grams;
+	}
+
+	BitmapIndex<uint32_t> index_;
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_TextIndex_hh
@@ -0,0 +1,190 @@
+#ifndef mfextensions_Receivers_detail_TimestampDecoder_hh
+#define mfextensions_Receivers_detail_TimestampDecoder_hh
+
+#include <sys/time.h>
+#include <cctype>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Decodes the "%d-%b-%Y %H:%M:%S" timestamps written by messagefacility (optionally with a fraction of a second
+/// after the seconds, and followed by a time zone name, which is ignored) into local-time epoch seconds.
+///
+/// The fields are read directly rather than through strptime. The epoch of the current minute is cached, and the
+/// epoch of local midnight is cached for the current day, so that mktime (which consults the time zone database) is
+/// only called when a message falls on a new day, or on a new minute of a day with a daylight saving change.
+///
+/// Not thread-safe; use one instance per parsing thread.
+/// </summary>
+class TimestampDecoder
+{
+public:
+	/**
+	 * \brief Decode a timestamp at the start of text
+	 * \param text Text starting with the timestamp; anything after it is ignored
+	 * \param[out] tv Decoded time, set only on success
+	 * \return True if text starts with a valid timestamp
+	 */
+	bool decode(std::string_view text, timeval& tv)
+	{
+		Fields f;
+		if (!parse(text, f)) return false;
+		tv.tv_sec = to_epoch(f);
+		tv.tv_usec = f.usec;
+		return true;
+	}
+
+	/**
+	 * \brief Look for a timestamp starting at one of the digits of text
+	 * \param text Text to search
+	 * \param[out] tv Decoded time of the first timestamp found
+	 * \return True if a timestamp was found
+	 */
+	bool find(std::string_view text, timeval& tv)
+	{
+		for (size_t pos = 0; pos < text.size(); ++pos)
+		{
+			if (isdigit(static_cast<unsigned char>(text[pos])) != 0 && decode(text.substr(pos), tv)) return true;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Broken-down timestamp, as read from the text
+	/// </summary>
+	struct Fields
+	{
+		int year = 0;  ///< Full year, e.g. 2026
+		int mon = 0;   ///< Month, 0-11
+		int mday = 0;  ///< Day of month, 1-31
+		int hour = 0;  ///< Hour, 0-23
+		int min = 0;   ///< Minute, 0-59
+		int sec = 0;   ///< Second, 0-60
+		int usec = 0;  ///< Microseconds, 0 if no fraction was given
+	};
+
+	/**
+	 * \brief Read the fields of a timestamp at the start of text
+	 * \param text Text starting with the timestamp
+	 * \param[out] f Fields read
+	 * \return True if text starts with a valid timestamp
+	 */
+	static bool parse(std::string_view text, Fields& f)
+	{
+		size_t pos = 0;
+		if (!read_int(text, pos, 2, f.mday) || f.mday < 1 || f.mday > 31) return false;
+		if (!expect(text, pos, '-') || !read_month(text, pos, f.mon) || !expect(text, pos, '-')) return false;
+		if (!read_int(text, pos, 4, f.year)) return false;
+		while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos])) != 0) ++pos;
+		if (!read_int(text, pos, 2, f.hour) || f.hour > 23 || !expect(text, pos, ':')) return false;
+		if (!read_int(text, pos, 2, f.min) || f.min > 59 || !expect(text, pos, ':')) return false;
+		if (!read_int(text, pos, 2, f.sec) || f.sec > 60) return false;
+
+		f.usec = 0;
+		if (pos + 1 < text.size() && text[pos] == '.' && isdigit(static_cast<unsigned char>(text[pos + 1])) != 0)
+		{
+			++pos;
+			int scale = 100000;
+			for (; pos < text.size() && isdigit(static_cast<unsigned char>(text[pos])) != 0; ++pos, scale /= 10)
+			{
+				f.usec += (text[pos] - '0') * scale;  // digits beyond microseconds add 0
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * \brief Convert local-time fields to epoch seconds, as mktime with tm_isdst = -1 would
+	 * \param f Fields to convert
+	 * \return Seconds since the epoch
+	 */
+	time_t to_epoch(Fields const& f)
+	{
+		int64_t minute_key = ((static_cast<int64_t>(f.year) * 12 + f.mon) * 32 + f.mday) * 1440 + f.hour * 60 + f.min;
+		if (minute_key != minute_key_)
+		{
+			int64_t day_key = minute_key / 1440;
+			if (day_key != day_key_)
+			{
+				day_key_ = day_key;
+				day_epoch_ = make_time(f, 0, 0);
+				// Without a daylight saving change during the day, minutes are a fixed offset from midnight
+				day_uniform_ = make_time(f, 23, 59) - day_epoch_ == 23 * 3600 + 59 * 60;
+			}
+			minute_epoch_ = day_uniform_ ? day_epoch_ + f.hour * 3600 + f.min * 60 : make_time(f, f.hour, f.min);
+			minute_key_ = minute_key;
+		}
+		return minute_epoch_ + f.sec;
+	}
+
+private:
+	static time_t make_time(Fields const& f, int hour, int min)
+	{
+		struct tm tm = {};
+		tm.tm_year = f.year - 1900;
+		tm.tm_mon = f.mon;
+		tm.tm_mday = f.mday;
+		tm.tm_hour = hour;
+		tm.tm_min = min;
+		tm.tm_isdst = -1;
+		return mktime(&tm);
+	}
+
+	static bool expect(std::string_view text, size_t& pos, char c)
+	{
+		if (pos >= text.size() || text[pos] != c) return false;
+		++pos;
+		return true;
+	}
+
+	static bool read_int(std::string_view text, size_t& pos, size_t max_digits, int& value)
+	{
+		auto start = pos;
+		value = 0;
+		while (pos < text.size() && pos - start < max_digits && isdigit(static_cast<unsigned char>(text[pos])) != 0)
+		{
+			value = value * 10 + (text[pos++] - '0');
+		}
+		return pos > start;
+	}
+
+	// Abbreviated or full month name, in any case (as strptime's %b)
+	static bool read_month(std::string_view text, size_t& pos, int& mon)
+	{
+		static constexpr std::string_view names[] = {"january", "february", "march", "april", "may", "june",
+		                                             "july", "august", "september", "october", "november", "december"};
+		if (pos + 3 > text.size()) return false;
+		for (int ii = 0; ii < 12; ++ii)
+		{
+			auto const& name = names[ii];  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+			size_t len = 0;
+			while (len < name.size() && pos + len < text.size() &&
+			       tolower(static_cast<unsigned char>(text[pos + len])) == name[len])
+			{
+				++len;
+			}
+			if (len == name.size() || len == 3)
+			{
+				pos += len;
+				mon = ii;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int64_t minute_key_ = -1;
+	time_t minute_epoch_ = 0;
+	int64_t day_key_ = -1;
+	time_t day_epoch_ = 0;
+	bool day_uniform_ = false;
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_TimestampDecoder_hh
@@ -0,0 +1,134 @@
+#ifndef mfextensions_Receivers_detail_UDPTextParser_hh
+#define mfextensions_Receivers_detail_UDPTextParser_hh
+
+#include "mfextensions/Receivers/detail/TimestampDecoder.hh"
+
+#include <charconv>
+#include <string_view>
+
+namespace mfviewer {
+namespace detail {
+
+/// <summary>
+/// Fields of a pipe-delimited "UDPMFMESSAGE" text datagram, as views into the datagram
+/// </summary>
+struct TextMessageFields
+{
+	bool has_timestamp = false;  ///< False if no token of the datagram holds a timestamp; all other fields are then empty
+	timeval time = {0, 0};       ///< Message time (valid if has_timestamp)
+	int seqNum = 0;              ///< Sender sequence number, 0 if absent
+	long pid = 0;                ///< Sender process ID, 0 if absent
+	std::string_view hostname;
+	std::string_view hostaddr;
+	std::string_view severity;
+	std::string_view category;
+	std::string_view application;
+	std::string_view iteration;
+	std::string_view module;
+	std::string_view file;
+	std::string_view line;
+	std::string_view body;  ///< Everything after the line number, including any '|' characters
+};
+
+/// <summary>
+/// Splits a text datagram into fields without copying it.
+///
+/// The datagram is scanned once for '|' separators. The message time is the first token that holds a timestamp
+/// starting at one of its digits (see TimestampDecoder), so that syslog-style prefixes ahead of it are skipped. The
+/// fields follow it in the order written by ELUDP; a sequence number or PID which is not a number is taken to be
+/// missing, and the token is read as the next field instead. The body is the rest of the datagram.
+/// </summary>
+class UDPTextParser
+{
+public:
+	/// Field separator of the text format
+	static constexpr char DELIMITER = '|';
+
+	/**
+	 * \brief Parse a text datagram
+	 * \param input Datagram contents
+	 * \param timestamps Decoder for the message time
+	 * \param[out] out Fields of the datagram, viewing into input
+	 */
+	static void parse(std::string_view input, TimestampDecoder& timestamps, TextMessageFields& out)
+	{
+		out = TextMessageFields();
+
+		Cursor cur{input};
+		std::string_view token;
+		while (cur.next(token))
+		{
+			if (timestamps.find(token, out.time))
+			{
+				out.has_timestamp = true;
+				break;
+			}
+		}
+		if (!out.has_timestamp) return;
+
+		if (!cur.next(token)) return;
+		if (!to_number(token, out.seqNum))
+		{
+			out.hostname = token;
+		}
+		else if (!cur.next(out.hostname))
+		{
+			return;
+		}
+		if (!cur.next(out.hostaddr) || !cur.next(out.severity) || !cur.next(out.category) ||
+		    !cur.next(out.application) || !cur.next(token))
+		{
+			return;
+		}
+		if (!to_number(token, out.pid))
+		{
+			out.iteration = token;
+		}
+		else if (!cur.next(out.iteration))
+		{
+			return;
+		}
+		if (!cur.next(out.module) || !cur.next(out.file) || !cur.next(out.line)) return;
+
+		out.body = cur.rest();
+		// A trailing separator does not start an empty token
+		if (!out.body.empty() && out.body.back() == DELIMITER) out.body.remove_suffix(1);
+	}
+
+private:
+	// Walks the '|'-separated tokens of the input
+	struct Cursor
+	{
+		std::string_view input;
+		size_t pos = 0;
+
+		bool next(std::string_view& token)
+		{
+			if (pos >= input.size()) return false;
+			auto end = input.find(DELIMITER, pos);
+			if (end == std::string_view::npos) end = input.size();
+			token = input.substr(pos, end - pos);
+			pos = end + 1;
+			return true;
+		}
+
+		std::string_view rest() const { return pos < input.size() ? input.substr(pos) : std::string_view(); }
+	};
+
+	// Leading whitespace and trailing characters are accepted, as std::stoi and std::stol did
+	template<typename T>
+	static bool to_number(std::string_view token, T& value)
+	{
+		auto start = token.find_first_not_of(" \t\n\r\f\v");
+		if (start == std::string_view::npos) return false;
+		auto first = token.data() + start;  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		if (*first == '+') ++first;         // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		auto res = std::from_chars(first, token.data() + token.size(), value);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		return res.ec == std::errc();
+	}
+};
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_UDPTextParser_hh
@@ -0,0 +1,582 @@
+#ifndef mfextensions_Receivers_detail_UDPWireFormat_hh
+#define mfextensions_Receivers_detail_UDPWireFormat_hh
+
+#include <arpa/inet.h>  // htons, ntohs
+#include <endian.h>     // htobe64, be64toh
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/**
+ * \file UDPWireFormat.hh
+ * Datagram layouts shared by the UDP_mfPlugin destination (ELUDP) and UDPReceiver.
+ *
+ * A plain datagram carries one text message, starting with "UDPMFMESSAGE". A framed datagram packs several
+ * complete payloads (each of which could have been sent on its own) into one packet:
+ *
+ *   "UDPMFFRAME" | uint8 version | uint8 reserved | uint16 record count | { uint16 length | payload } * count
+ *
+ * A binary record replaces the pipe-delimited text of a single message:
+ *
+ *   "UDPMFBIN" | uint8 version | uint8 severity level | uint16 reserved | uint64 timestamp (us since epoch)
+ *   | uint32 sequence number | uint32 pid | uint32 line | hostname | hostaddr | category | application
+ *   | iteration | module | file | message
+ *
+ * where each string is a uint16 length followed by its bytes, except the message, which has a uint32 length.
+ *
+ * In dictionary mode, a sender assigns small ids to strings that repeat (host, address, application, category,
+ * module, file) and periodically announces its id table, keyed by a random per-process session id:
+ *
+ *   "UDPMFDICT" | uint8 version | uint8 reserved | uint16 entry count | uint64 session | uint32 pid
+ *   | { uint16 id | string } * count
+ *
+ * Its messages then carry only the ids:
+ *
+ *   "UDPMFDMSG" | uint8 version | uint8 severity level | uint16 reserved | uint64 session | uint64 timestamp
+ *   | uint32 sequence number | uint32 line | uint16 hostname id | uint16 hostaddr id | uint16 application id
+ *   | uint16 category id | uint16 module id | uint16 file id | iteration | message
+ *
+ * A payload too large for one datagram is split into fragments, each carrying a slice of the original payload:
+ *
+ *   "UDPMFFRAG" | uint8 version | uint8 reserved | uint16 fragment index | uint16 fragment count | uint64 session
+ *   | uint32 message id | uint32 total length | uint32 offset | data
+ *
+ * The receiver reassembles the payload from the fragments sharing a (session, message id) and handles it as if
+ * it had arrived in one datagram.
+ *
+ * Binary, dictionary, dictionary message and fragment records may appear on their own or as records of a framed
+ * datagram.
+ *
+ * All integers are in network byte order.
+ */
+
+namespace mfviewer {
+namespace detail {
+
+/// Marker at the start of a framed (multi-record) datagram
+constexpr char FRAMED_MAGIC[] = "UDPMFFRAME";
+/// Length of FRAMED_MAGIC, without the terminating NUL
+constexpr size_t FRAMED_MAGIC_SIZE = sizeof(FRAMED_MAGIC) - 1;
+/// Current version of the framed layout
+constexpr uint8_t FRAMED_VERSION = 1;
+/// Size of the framed datagram header (magic, version, reserved byte and record count)
+constexpr size_t FRAMED_HEADER_SIZE = FRAMED_MAGIC_SIZE + 4;
+/// Size of the length prefix in front of each record
+constexpr size_t FRAMED_RECORD_HEADER_SIZE = 2;
+/// Largest payload that fits in a single UDP/IPv4 datagram
+constexpr size_t MAX_UDP_PAYLOAD = 65507;
+/// Highest severity byte a record may carry (mf::ELseverityLevel::ELsev_highestSeverity)
+constexpr uint8_t MAX_SEVERITY = 7;
+
+/**
+ * \brief Determine whether a datagram uses the framed multi-record layout
+ * \param buf Datagram contents
+ * \param len Datagram length
+ * \return True if the datagram starts with a framed header
+ */
+inline bool is_framed(char const* buf, size_t len)
+{
+	return len >= FRAMED_HEADER_SIZE && memcmp(buf, FRAMED_MAGIC, FRAMED_MAGIC_SIZE) == 0;
+}
+
+/**
+ * \brief Start a new framed datagram in the given buffer (any previous contents are discarded)
+ * \param frame Buffer to hold the datagram
+ */
+inline void begin_frame(std::string& frame)
+{
+	frame.assign(FRAMED_MAGIC, FRAMED_MAGIC_SIZE);
+	frame.push_back(static_cast<char>(FRAMED_VERSION));
+	frame.push_back(0);
+	frame.append(2, '\0');
+}
+
+/**
+ * \brief Number of records currently stored in a framed datagram
+ * \param frame Datagram started with begin_frame
+ * \return Record count
+ */
+inline uint16_t frame_record_count(std::string const& frame)
+{
+	uint16_t count;
+	memcpy(&count, &frame[FRAMED_MAGIC_SIZE + 2], sizeof(count));
+	return ntohs(count);
+}
+
+/**
+ * \brief Append a record to a framed datagram, if it fits
+ * \param frame Datagram started with begin_frame
+ * \param data Record contents
+ * \param len Record length
+ * \param max_size Maximum size of the datagram
+ * \return True if the record was appended, false if it would make the datagram larger than max_size
+ */
+inline bool append_record(std::string& frame, char const* data, size_t len, size_t max_size)
+{
+	auto count = frame_record_count(frame);
+	if (count == UINT16_MAX || frame.size() + FRAMED_RECORD_HEADER_SIZE + len > max_size) return false;
+
+	uint16_t netlen = htons(static_cast<uint16_t>(len));
+	frame.append(reinterpret_cast<char const*>(&netlen), sizeof(netlen));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	frame.append(data, len);
+
+	uint16_t netcount = htons(count + 1);
+	memcpy(&frame[FRAMED_MAGIC_SIZE + 2], &netcount, sizeof(netcount));
+	return true;
+}
+
+/**
+ * \brief Call a function for each record in a framed datagram
+ * \param buf Datagram contents
+ * \param len Datagram length
+ * \param fn Callable taking (char const* data, size_t len) for each record
+ * \return False if the datagram is truncated or has an unknown version. Records before the damage are still delivered.
+ */
+template<typename Fn>
+bool unpack_frame(char const* buf, size_t len, Fn&& fn)
+{
+	if (!is_framed(buf, len) || static_cast<uint8_t>(buf[FRAMED_MAGIC_SIZE]) != FRAMED_VERSION) return false;
+
+	uint16_t count;
+	memcpy(&count, buf + FRAMED_MAGIC_SIZE + 2, sizeof(count));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	count = ntohs(count);
+
+	size_t pos = FRAMED_HEADER_SIZE;
+	for (uint16_t ii = 0; ii < count; ++ii)
+	{
+		if (pos + FRAMED_RECORD_HEADER_SIZE > len) return false;
+		uint16_t reclen;
+		memcpy(&reclen, buf + pos, sizeof(reclen));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		reclen = ntohs(reclen);
+		pos += FRAMED_RECORD_HEADER_SIZE;
+
+		if (pos + reclen > len) return false;
+		fn(buf + pos, static_cast<size_t>(reclen));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		pos += reclen;
+	}
+	return true;
+}
+
+/// Marker at the start of a binary message record
+constexpr char BINARY_MAGIC[] = "UDPMFBIN";
+/// Length of BINARY_MAGIC, without the terminating NUL
+constexpr size_t BINARY_MAGIC_SIZE = sizeof(BINARY_MAGIC) - 1;
+/// Current version of the binary record layout
+constexpr uint8_t BINARY_VERSION = 1;
+/// Size of the fixed-length part of a binary record
+constexpr size_t BINARY_HEADER_SIZE = BINARY_MAGIC_SIZE + 4 + 8 + 4 + 4 + 4;
+
+/// <summary>
+/// Fields of a message in the binary encoding. Strings refer to storage owned by the caller (when encoding) or
+/// to the datagram buffer (when decoding).
+/// </summary>
+struct BinaryRecord
+{
+	uint8_t severity = 0;           ///< mf::ELseverityLevel level
+	uint64_t timestamp_us = 0;      ///< Message time, microseconds since the epoch
+	uint32_t seqNum = 0;            ///< Sender's message sequence number
+	uint32_t pid = 0;               ///< Sender's process ID
+	uint32_t line = 0;              ///< Source line number
+	std::string_view hostname;      ///< Sender's host name
+	std::string_view hostaddr;      ///< Sender's host address
+	std::string_view category;      ///< Message category (id)
+	std::string_view application;   ///< Sender's application name
+	std::string_view iteration;     ///< Run/event number
+	std::string_view module;        ///< Module name
+	std::string_view file;          ///< Source file name
+	std::string_view message;       ///< Message body
+};
+
+/**
+ * \brief Determine whether a payload is a binary message record
+ * \param buf Payload contents
+ * \param len Payload length
+ * \return True if the payload starts with the binary record marker
+ */
+inline bool is_binary_record(char const* buf, size_t len)
+{
+	return len >= BINARY_HEADER_SIZE && memcmp(buf, BINARY_MAGIC, BINARY_MAGIC_SIZE) == 0;
+}
+
+namespace wire {
+template<typename T>
+inline void put(std::string& out, T value)
+{
+	out.append(reinterpret_cast<char const*>(&value), sizeof(value));  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+template<typename T>
+inline T get(char const* buf)
+{
+	T value;
+	memcpy(&value, buf, sizeof(value));
+	return value;
+}
+
+inline void put_be64(std::string& out, uint64_t value) { put(out, htobe64(value)); }
+
+inline void put_string16(std::string& out, std::string_view str)
+{
+	if (str.size() > UINT16_MAX) str = str.substr(0, UINT16_MAX);
+	put(out, htons(static_cast<uint16_t>(str.size())));
+	out.append(str.data(), str.size());
+}
+
+inline bool get_string(char const* buf, size_t len, size_t& pos, size_t lensize, std::string_view& str)
+{
+	if (pos + lensize > len) return false;
+	size_t strlen = lensize == 2 ? ntohs(get<uint16_t>(buf + pos)) : ntohl(get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += lensize;
+	if (pos + strlen > len) return false;
+	str = std::string_view(buf + pos, strlen);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += strlen;
+	return true;
+}
+}  // namespace wire
+
+/**
+ * \brief Append the binary encoding of a message to a buffer
+ * \param out Buffer to append to
+ * \param rec Message fields. Strings longer than their length prefix allows are truncated.
+ */
+inline void append_binary_record(std::string& out, BinaryRecord const& rec)
+{
+	out.append(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+	out.push_back(static_cast<char>(BINARY_VERSION));
+	out.push_back(static_cast<char>(rec.severity));
+	wire::put(out, uint16_t{0});
+	wire::put_be64(out, rec.timestamp_us);
+	wire::put(out, htonl(rec.seqNum));
+	wire::put(out, htonl(rec.pid));
+	wire::put(out, htonl(rec.line));
+	wire::put_string16(out, rec.hostname);
+	wire::put_string16(out, rec.hostaddr);
+	wire::put_string16(out, rec.category);
+	wire::put_string16(out, rec.application);
+	wire::put_string16(out, rec.iteration);
+	wire::put_string16(out, rec.module);
+	wire::put_string16(out, rec.file);
+	wire::put(out, htonl(static_cast<uint32_t>(rec.message.size())));
+	out.append(rec.message.data(), rec.message.size());
+}
+
+/**
+ * \brief Decode a binary message record
+ * \param buf Payload contents. Must outlive the string views stored in rec.
+ * \param len Payload length
+ * \param[out] rec Decoded message fields
+ * \return False if the payload is not a binary record of a known version, is truncated, or has an unknown severity
+ */
+inline bool decode_binary_record(char const* buf, size_t len, BinaryRecord& rec)
+{
+	if (!is_binary_record(buf, len) || static_cast<uint8_t>(buf[BINARY_MAGIC_SIZE]) != BINARY_VERSION) return false;
+
+	size_t pos = BINARY_MAGIC_SIZE + 1;
+	rec.severity = static_cast<uint8_t>(buf[pos]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	if (rec.severity > MAX_SEVERITY) return false;
+	pos += 3;
+	rec.timestamp_us = be64toh(wire::get<uint64_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 8;
+	rec.seqNum = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+	rec.pid = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+	rec.line = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+
+	return wire::get_string(buf, len, pos, 2, rec.hostname) && wire::get_string(buf, len, pos, 2, rec.hostaddr) &&
+	       wire::get_string(buf, len, pos, 2, rec.category) && wire::get_string(buf, len, pos, 2, rec.application) &&
+	       wire::get_string(buf, len, pos, 2, rec.iteration) && wire::get_string(buf, len, pos, 2, rec.module) &&
+	       wire::get_string(buf, len, pos, 2, rec.file) && wire::get_string(buf, len, pos, 4, rec.message);
+}
+
+/// Marker at the start of a dictionary announcement
+constexpr char DICTIONARY_MAGIC[] = "UDPMFDICT";
+/// Marker at the start of a message record that refers to dictionary ids
+constexpr char DICTIONARY_RECORD_MAGIC[] = "UDPMFDMSG";
+/// Length of DICTIONARY_MAGIC and DICTIONARY_RECORD_MAGIC, without the terminating NUL
+constexpr size_t DICTIONARY_MAGIC_SIZE = sizeof(DICTIONARY_MAGIC) - 1;
+static_assert(sizeof(DICTIONARY_MAGIC) == sizeof(DICTIONARY_RECORD_MAGIC), "Dictionary markers must have the same length");
+/// Current version of the dictionary layouts
+constexpr uint8_t DICTIONARY_VERSION = 1;
+/// Size of the fixed-length part of a dictionary announcement
+constexpr size_t DICTIONARY_HEADER_SIZE = DICTIONARY_MAGIC_SIZE + 4 + 8 + 4;
+/// Size of the fixed-length part of a dictionary message record
+constexpr size_t DICTIONARY_RECORD_HEADER_SIZE = DICTIONARY_MAGIC_SIZE + 4 + 8 + 8 + 4 + 4 + 6 * 2;
+
+/// <summary>
+/// Fields of a message in the dictionary encoding. String ids refer to the sender's announced table.
+/// </summary>
+struct DictionaryRecord
+{
+	uint8_t severity = 0;           ///< mf::ELseverityLevel level
+	uint64_t session = 0;           ///< Sender's session id, selects the dictionary
+	uint64_t timestamp_us = 0;      ///< Message time, microseconds since the epoch
+	uint32_t seqNum = 0;            ///< Sender's message sequence number
+	uint32_t line = 0;              ///< Source line number
+	uint16_t hostname = 0;          ///< Id of the sender's host name
+	uint16_t hostaddr = 0;          ///< Id of the sender's host address
+	uint16_t application = 0;       ///< Id of the sender's application name
+	uint16_t category = 0;          ///< Id of the message category
+	uint16_t module = 0;            ///< Id of the module name
+	uint16_t file = 0;              ///< Id of the source file name
+	std::string_view iteration;     ///< Run/event number
+	std::string_view message;       ///< Message body
+};
+
+/**
+ * \brief Determine whether a payload is a dictionary announcement
+ * \param buf Payload contents
+ * \param len Payload length
+ * \return True if the payload starts with the dictionary marker
+ */
+inline bool is_dictionary(char const* buf, size_t len)
+{
+	return len >= DICTIONARY_HEADER_SIZE && memcmp(buf, DICTIONARY_MAGIC, DICTIONARY_MAGIC_SIZE) == 0;
+}
+
+/**
+ * \brief Determine whether a payload is a message record using dictionary ids
+ * \param buf Payload contents
+ * \param len Payload length
+ * \return True if the payload starts with the dictionary message marker
+ */
+inline bool is_dictionary_record(char const* buf, size_t len)
+{
+	return len >= DICTIONARY_RECORD_HEADER_SIZE && memcmp(buf, DICTIONARY_RECORD_MAGIC, DICTIONARY_MAGIC_SIZE) == 0;
+}
+
+/**
+ * \brief Start a new dictionary announcement in the given buffer (any previous contents are discarded)
+ * \param out Buffer to hold the announcement
+ * \param session Sender's session id
+ * \param pid Sender's process ID
+ */
+inline void begin_dictionary(std::string& out, uint64_t session, uint32_t pid)
+{
+	out.assign(DICTIONARY_MAGIC, DICTIONARY_MAGIC_SIZE);
+	out.push_back(static_cast<char>(DICTIONARY_VERSION));
+	out.push_back(0);
+	wire::put(out, uint16_t{0});
+	wire::put_be64(out, session);
+	wire::put(out, htonl(pid));
+}
+
+/**
+ * \brief Append an id/string pair to a dictionary announcement, if it fits
+ * \param out Announcement started with begin_dictionary
+ * \param id Id of the string
+ * \param str String value (at most UINT16_MAX bytes are stored)
+ * \param max_size Maximum size of the announcement
+ * \return True if the entry was appended, false if it would make the announcement larger than max_size
+ */
+inline bool append_dictionary_entry(std::string& out, uint16_t id, std::string_view str, size_t max_size)
+{
+	if (str.size() > UINT16_MAX) str = str.substr(0, UINT16_MAX);
+
+	uint16_t count = ntohs(wire::get<uint16_t>(&out[DICTIONARY_MAGIC_SIZE + 2]));
+	if (count == UINT16_MAX || out.size() + 4 + str.size() > max_size) return false;
+
+	wire::put(out, htons(id));
+	wire::put_string16(out, str);
+
+	uint16_t netcount = htons(count + 1);
+	memcpy(&out[DICTIONARY_MAGIC_SIZE + 2], &netcount, sizeof(netcount));
+	return true;
+}
+
+/**
+ * \brief Decode a dictionary announcement
+ * \param buf Payload contents
+ * \param len Payload length
+ * \param[out] session Sender's session id
+ * \param[out] pid Sender's process ID
+ * \param fn Callable taking (uint16_t id, std::string_view str) for each entry
+ * \return False if the payload is truncated or has an unknown version. Entries before the damage are still delivered.
+ */
+template<typename Fn>
+bool unpack_dictionary(char const* buf, size_t len, uint64_t& session, uint32_t& pid, Fn&& fn)
+{
+	if (!is_dictionary(buf, len) || static_cast<uint8_t>(buf[DICTIONARY_MAGIC_SIZE]) != DICTIONARY_VERSION) return false;
+
+	size_t pos = DICTIONARY_MAGIC_SIZE + 2;
+	uint16_t count = ntohs(wire::get<uint16_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 2;
+	session = be64toh(wire::get<uint64_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 8;
+	pid = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+
+	for (uint16_t ii = 0; ii < count; ++ii)
+	{
+		if (pos + 2 > len) return false;
+		uint16_t id = ntohs(wire::get<uint16_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		pos += 2;
+		std::string_view str;
+		if (!wire::get_string(buf, len, pos, 2, str)) return false;
+		fn(id, str);
+	}
+	return true;
+}
+
+/**
+ * \brief Append the dictionary encoding of a message to a buffer
+ * \param out Buffer to append to
+ * \param rec Message fields
+ */
+inline void append_dictionary_record(std::string& out, DictionaryRecord const& rec)
+{
+	out.append(DICTIONARY_RECORD_MAGIC, DICTIONARY_MAGIC_SIZE);
+	out.push_back(static_cast<char>(DICTIONARY_VERSION));
+	out.push_back(static_cast<char>(rec.severity));
+	wire::put(out, uint16_t{0});
+	wire::put_be64(out, rec.session);
+	wire::put_be64(out, rec.timestamp_us);
+	wire::put(out, htonl(rec.seqNum));
+	wire::put(out, htonl(rec.line));
+	for (auto id : {rec.hostname, rec.hostaddr, rec.application, rec.category, rec.module, rec.file})
+	{
+		wire::put(out, htons(id));
+	}
+	wire::put_string16(out, rec.iteration);
+	wire::put(out, htonl(static_cast<uint32_t>(rec.message.size())));
+	out.append(rec.message.data(), rec.message.size());
+}
+
+/**
+ * \brief Decode a message record using dictionary ids
+ * \param buf Payload contents. Must outlive the string views stored in rec.
+ * \param len Payload length
+ * \param[out] rec Decoded message fields
+ * \return False if the payload is not a dictionary message record of a known version, is truncated, or has an unknown severity
+ */
+inline bool decode_dictionary_record(char const* buf, size_t len, DictionaryRecord& rec)
+{
+	if (!is_dictionary_record(buf, len) || static_cast<uint8_t>(buf[DICTIONARY_MAGIC_SIZE]) != DICTIONARY_VERSION) return false;
+
+	size_t pos = DICTIONARY_MAGIC_SIZE + 1;
+	rec.severity = static_cast<uint8_t>(buf[pos]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	if (rec.severity > MAX_SEVERITY) return false;
+	pos += 3;
+	rec.session = be64toh(wire::get<uint64_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 8;
+	rec.timestamp_us = be64toh(wire::get<uint64_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 8;
+	rec.seqNum = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+	rec.line = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+	for (auto id : {&rec.hostname, &rec.hostaddr, &rec.application, &rec.category, &rec.module, &rec.file})
+	{
+		*id = ntohs(wire::get<uint16_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		pos += 2;
+	}
+
+	return wire::get_string(buf, len, pos, 2, rec.iteration) && wire::get_string(buf, len, pos, 4, rec.message);
+}
+
+/// Marker at the start of a fragment of a large payload
+constexpr char FRAGMENT_MAGIC[] = "UDPMFFRAG";
+/// Length of FRAGMENT_MAGIC, without the terminating NUL
+constexpr size_t FRAGMENT_MAGIC_SIZE = sizeof(FRAGMENT_MAGIC) - 1;
+/// Current version of the fragment layout
+constexpr uint8_t FRAGMENT_VERSION = 1;
+/// Size of the fragment header
+constexpr size_t FRAGMENT_HEADER_SIZE = FRAGMENT_MAGIC_SIZE + 2 + 2 + 2 + 8 + 4 + 4 + 4;
+
+/// <summary>
+/// Header of a fragment of a large payload
+/// </summary>
+struct FragmentHeader
+{
+	uint16_t index = 0;         ///< Position of this fragment, starting at 0
+	uint16_t count = 0;         ///< Number of fragments making up the payload
+	uint64_t session = 0;       ///< Sender's session id
+	uint32_t message_id = 0;    ///< Sender's id for the payload, unique within the session
+	uint32_t total_length = 0;  ///< Size of the reassembled payload
+	uint32_t offset = 0;        ///< Position of this fragment's data in the reassembled payload
+};
+
+/**
+ * \brief Determine whether a payload is a fragment of a larger one
+ * \param buf Payload contents
+ * \param len Payload length
+ * \return True if the payload starts with the fragment marker
+ */
+inline bool is_fragment(char const* buf, size_t len)
+{
+	return len >= FRAGMENT_HEADER_SIZE && memcmp(buf, FRAGMENT_MAGIC, FRAGMENT_MAGIC_SIZE) == 0;
+}
+
+/**
+ * \brief Split a payload into fragments of at most max_size bytes (headers included)
+ * \param payload Payload to split
+ * \param session Sender's session id
+ * \param message_id Sender's id for this payload
+ * \param max_size Maximum size of each fragment, must be larger than FRAGMENT_HEADER_SIZE
+ * \param scratch Buffer used to build each fragment
+ * \param fn Callable taking (std::string const& fragment), called once per fragment in order
+ * \return False (and nothing is delivered) if the payload would need more than UINT16_MAX fragments or is larger than UINT32_MAX bytes
+ */
+template<typename Fn>
+bool split_fragments(std::string_view payload, uint64_t session, uint32_t message_id, size_t max_size, std::string& scratch, Fn&& fn)
+{
+	if (max_size <= FRAGMENT_HEADER_SIZE || payload.size() > UINT32_MAX) return false;
+
+	auto const chunk = max_size - FRAGMENT_HEADER_SIZE;
+	auto const count = (payload.size() + chunk - 1) / chunk;
+	if (count == 0 || count > UINT16_MAX) return false;
+
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		auto const offset = ii * chunk;
+		scratch.assign(FRAGMENT_MAGIC, FRAGMENT_MAGIC_SIZE);
+		scratch.push_back(static_cast<char>(FRAGMENT_VERSION));
+		scratch.push_back(0);
+		wire::put(scratch, htons(static_cast<uint16_t>(ii)));
+		wire::put(scratch, htons(static_cast<uint16_t>(count)));
+		wire::put_be64(scratch, session);
+		wire::put(scratch, htonl(message_id));
+		wire::put(scratch, htonl(static_cast<uint32_t>(payload.size())));
+		wire::put(scratch, htonl(static_cast<uint32_t>(offset)));
+		scratch.append(payload.substr(offset, chunk));
+		fn(static_cast<std::string const&>(scratch));
+	}
+	return true;
+}
+
+/**
+ * \brief Decode a fragment
+ * \param buf Payload contents. Must outlive data.
+ * \param len Payload length
+ * \param[out] hdr Fragment header
+ * \param[out] data This fragment's slice of the original payload
+ * \return False if the payload is not a fragment of a known version, or its header is inconsistent
+ */
+inline bool decode_fragment(char const* buf, size_t len, FragmentHeader& hdr, std::string_view& data)
+{
+	if (!is_fragment(buf, len) || static_cast<uint8_t>(buf[FRAGMENT_MAGIC_SIZE]) != FRAGMENT_VERSION) return false;
+
+	size_t pos = FRAGMENT_MAGIC_SIZE + 2;
+	hdr.index = ntohs(wire::get<uint16_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 2;
+	hdr.count = ntohs(wire::get<uint16_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 2;
+	hdr.session = be64toh(wire::get<uint64_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 8;
+	hdr.message_id = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+	hdr.total_length = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+	hdr.offset = ntohl(wire::get<uint32_t>(buf + pos));  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	pos += 4;
+
+	data = std::string_view(buf + pos, len - pos);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	return hdr.index < hdr.count && static_cast<uint64_t>(hdr.offset) + data.size() <= hdr.total_length;
+}
+
+}  // namespace detail
+}  // namespace mfviewer
+
+#endif  // mfextensions_Receivers_detail_UDPWireFormat_hh
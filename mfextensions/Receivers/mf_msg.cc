@@ -0,0 +1,36 @@
+#include "mfextensions/Receivers/mf_msg.hh"
+#include "mfextensions/Receivers/detail/BlockSequence.hh"
+#include "mfextensions/Receivers/detail/PoolAllocator.hh"
+
+sev_code_t mf_msg::severity_code(mf::ELseverityLevel sev)
+{
+	switch (sev.getLevel())
+	{
+		case mf::ELseverityLevel::ELsev_success:
+		case mf::ELseverityLevel::ELsev_zeroSeverity:
+		case mf::ELseverityLevel::ELsev_unspecified:
+			return SDEBUG;
+
+		case mf::ELseverityLevel::ELsev_info:
+			return SINFO;
+
+		case mf::ELseverityLevel::ELsev_warning:
+			return SWARNING;
+
+		case mf::ELseverityLevel::ELsev_error:
+		case mf::ELseverityLevel::ELsev_severe:
+		case mf::ELseverityLevel::ELsev_highestSeverity:
+		default:
+			return SERROR;
+	}
+}
+
+size_t mf_msg::next_sequence()
+{
+	// Receiver threads each take numbers from a block of their own, rather than all incrementing one counter
+	static mfviewer::detail::BlockSequence sequence(4096);
+	thread_local mfviewer::detail::BlockSequence::Block block;
+	return sequence.next(block);
+}
+
+mf_msg_ptr_t mf_msg::create() { return std::allocate_shared<mf_msg>(mfviewer::detail::PoolAllocator<mf_msg>()); }
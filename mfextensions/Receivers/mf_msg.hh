@@ -0,0 +1,78 @@
+#ifndef mfextensions_Receivers_mf_msg_hh
+#define mfextensions_Receivers_mf_msg_hh
+
+// Plain C++ message type produced by the receivers, free of any Qt dependency
+// so that headless consumers (e.g. msgserver) do not need a Qt runtime
+
+#include <sys/time.h>
+#include <sys/types.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "messagefacility/Utilities/ELseverityLevel.h"
+
+/// <summary>
+/// Severity codes enumeration for internal use
+/// </summary>
+enum sev_code_t
+{
+	SDEBUG,
+	SINFO,
+	SWARNING,
+	SERROR
+};
+
+/// <summary>
+/// A MessageFacility message as decoded by a receiver
+/// </summary>
+struct mf_msg
+{
+	std::string hostname;     ///< Host name of the message source
+	std::string hostaddr;     ///< Host address of the message source
+	std::string category;     ///< Message category
+	std::string application;  ///< Application which sent the message
+	pid_t pid = 0;            ///< Process ID of the message source
+	timeval time = {0, 0};    ///< Message timestamp
+	sev_code_t sev = SERROR;  ///< Severity code
+	std::string sourceType;   ///< Receiver-specific description of where the message came from
+	int sourceSequence = 0;   ///< Sequence number within sourceType
+	std::string file;         ///< Source file which generated the message
+	std::string line;         ///< Line number in file
+	std::string module;       ///< Module which generated the message
+	std::string eventID;      ///< Run/event number
+	std::string message;      ///< Message text
+	size_t seq = next_sequence();  ///< Unique number, increasing on each receiving thread; breaks ties in time
+
+	/// <summary>
+	/// Map a MessageFacility severity level to a severity code
+	/// </summary>
+	/// <param name="sev">MessageFacility severity level</param>
+	/// <returns>Corresponding severity code</returns>
+	static sev_code_t severity_code(mf::ELseverityLevel sev);
+
+	/// <summary>
+	/// Allocate the next receive sequence number. May be called from any thread; numbers are unique across threads
+	/// and increase within each thread, but are only ordered in time for messages received by the same thread.
+	/// </summary>
+	/// <returns>Sequence number, starting at 1</returns>
+	static size_t next_sequence();
+
+	/// <summary>
+	/// Allocate an empty message from the shared message pools (see detail::PoolAllocator). May be called from any thread.
+	/// </summary>
+	/// <returns>New message</returns>
+	static std::shared_ptr<mf_msg> create();
+};
+
+/// <summary>
+/// A std::shared_ptr to a mf_msg
+/// </summary>
+typedef std::shared_ptr<mf_msg> mf_msg_ptr_t;
+
+/// <summary>
+/// A batch of mf_msg delivered together
+/// </summary>
+typedef std::vector<mf_msg_ptr_t> mf_msg_batch_t;
+
+#endif  // mfextensions_Receivers_mf_msg_hh
@@ -3,109 +3,221 @@
 #include "messagefacility/MessageService/ELdestination.h"
 #include "mfextensions/Receivers/qt_mf_msg.hh"
 //#include "mfextensions/Extensions/MFExtensions.hh"
+#include <atomic>
 #include <iostream>
+#include <unordered_map>
 
-size_t qt_mf_msg::sequence = 0;
+namespace {
+QString escaped(std::string_view field) { return QString::fromUtf8(field.data(), static_cast<int>(field.size())).toHtmlEscaped(); }
 
-qt_mf_msg::qt_mf_msg(const std::string& hostname, const std::string& category, const std::string& application, pid_t pid, timeval time)
-    : text_()
-    , shortText_()
-    , color_()
-    , sev_(SERROR)
-    , host_(QString(hostname.c_str()))
-    , cat_(QString(category.c_str()))
-    , app_(QString((application + " (" + std::to_string(pid) + ")").c_str()))
-    , time_(time)
-    , seq_(++sequence)
-    , msg_("")
-    , application_(QString(application.c_str()).toHtmlEscaped())
-    , pid_(QString::number(pid)) {}
+QString escaped(str_id_t field) { return qt_mf_msg::strings()[field].toHtmlEscaped(); }
 
-void qt_mf_msg::setSeverity(mf::ELseverityLevel sev)
+QString severity_name(sev_code_t sev)
 {
-	int sevid = sev.getLevel();
-
-	switch (sevid)
+	switch (sev)
 	{
-		case mf::ELseverityLevel::ELsev_success:
-		case mf::ELseverityLevel::ELsev_zeroSeverity:
-		case mf::ELseverityLevel::ELsev_unspecified:
-			sev_ = SDEBUG;
-			break;
+		case SDEBUG:
+			return "Debug";
+		case SINFO:
+			return "Info";
+		case SWARNING:
+			return "Warning";
+		default:
+			return "Error";
+	}
+}
 
-		case mf::ELseverityLevel::ELsev_info:
-			sev_ = SINFO;
-			break;
+// Messages to set aside pool memory for, and the size of the block allocate_shared asks for per message (0 until
+// the first message is created)
+std::atomic<size_t> reserved_messages{0};
+std::atomic<size_t> message_block_bytes{0};
 
-		case mf::ELseverityLevel::ELsev_warning:
-			sev_ = SWARNING;
-			break;
+void reserve_message_pool(size_t bytes)
+{
+	auto count = reserved_messages.exchange(0);
+	auto pool = mfviewer::detail::SizeClassPools::pool_for(bytes);
+	if (pool != nullptr && count > 0) pool->reserve(count);
+}
 
-		case mf::ELseverityLevel::ELsev_error:
-		case mf::ELseverityLevel::ELsev_severe:
-		case mf::ELseverityLevel::ELsev_highestSeverity:
-			sev_ = SERROR;
-			break;
+// Handle of the interned "application (pid)" display name. Every message from a process carries the same pair, so
+// the handles are cached per thread on (application handle, pid), and the string is only built on a miss.
+str_id_t intern_app(str_id_t application, pid_t pid)
+{
+	thread_local std::unordered_map<uint64_t, str_id_t> cache;
+	auto key = (static_cast<uint64_t>(application) << 32) | static_cast<uint32_t>(pid);
+	auto it = cache.find(key);
+	if (it != cache.end()) return it->second;
+
+	auto id = qt_mf_msg::intern(qt_mf_msg::strings().key(application) + " (" + std::to_string(pid) + ")");
+	cache.emplace(key, id);
+	return id;
+}
 
-		default:
-			break;
+// PoolAllocator for create(). allocate_shared rebinds it to its own block type (the message together with the
+// shared_ptr control block, laid out as the standard library sees fit), so the size it asks for is the one to reserve.
+template<typename T>
+class MessageAllocator : public mfviewer::detail::PoolAllocator<T>
+{
+public:
+	typedef T value_type;  ///< Type allocated
+
+	MessageAllocator() noexcept = default;
+
+	template<typename U>
+	MessageAllocator(MessageAllocator<U> const&) noexcept  // NOLINT(google-explicit-constructor)
+	{}
+
+	T* allocate(size_t n)
+	{
+		auto bytes = n * sizeof(T);
+		if (message_block_bytes.load(std::memory_order_relaxed) != bytes)
+		{
+			message_block_bytes = bytes;
+			reserve_message_pool(bytes);
+		}
+		return mfviewer::detail::PoolAllocator<T>::allocate(n);
 	}
+};
+}  // namespace
+
+mfviewer::detail::InternTable<QString>& qt_mf_msg::strings()
+{
+	static mfviewer::detail::InternTable<QString> table;
+	static str_id_t const empty = table.intern("", QString::fromStdString);  // handle 0, for default-constructed messages
+	(void)empty;
+	return table;
+}
+
+str_id_t qt_mf_msg::intern(std::string const& str) { return strings().intern(str, QString::fromStdString); }
+
+qt_mf_msg::qt_mf_msg(const std::string& hostname, const std::string& category, const std::string& application, pid_t pid, timeval time)
+    : host_(intern(hostname))
+    , cat_(intern(category))
+    , app_(0)
+    , application_(intern(application))
+    , module_(0)
+    , hostaddr_(0)
+    , file_(0)
+    , sev_(SERROR)
+    , pid_(pid)
+    , time_(time)
+    , sourceSequence_(0)
+    , seq_(mf_msg::next_sequence())
+    , text_valid_(false)
+{
+	app_ = intern_app(application_, pid_);
+}
+
+qt_mf_msg::qt_mf_msg(mf_msg const& msg)
+    : host_(intern(msg.hostname))
+    , cat_(intern(msg.category))
+    , app_(0)
+    , application_(intern(msg.application))
+    , module_(intern(msg.module))
+    , hostaddr_(intern(msg.hostaddr))
+    , file_(intern(msg.file))
+    , sev_(msg.sev)
+    , pid_(msg.pid)
+    , time_(msg.time)
+    , sourceSequence_(msg.sourceSequence)
+    , seq_(msg.seq)
+    , line_(msg.line.begin(), msg.line.end())
+    , eventID_(msg.eventID.begin(), msg.eventID.end())
+    , sourceType_(msg.sourceType.begin(), msg.sourceType.end())
+    , message_(msg.message.begin(), msg.message.end())
+    , text_valid_(false)
+{
+	app_ = intern_app(application_, pid_);
+}
+
+std::shared_ptr<qt_mf_msg> qt_mf_msg::create(mf_msg const& msg)
+{
+	return std::allocate_shared<qt_mf_msg>(MessageAllocator<qt_mf_msg>(), msg);
+}
+
+void qt_mf_msg::reserve(size_t count)
+{
+	// The block size is only known once create() has allocated; until then the reservation waits for it
+	reserved_messages = count;
+	auto bytes = message_block_bytes.load();
+	if (bytes != 0) reserve_message_pool(bytes);
+}
+
+QColor const& qt_mf_msg::color() const
+{
+	static QColor const colors[] = {QColor(80, 80, 80), QColor(0, 128, 0), QColor(224, 128, 0), QColor(255, 0, 0)};
+	return colors[sev_];  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
 }
 
 void qt_mf_msg::setMessage(std::string const& prefix, int iteration, std::string const& msg)
 {
-	sourceType_ = QString(prefix.c_str()).toHtmlEscaped();
+	sourceType_.assign(prefix.begin(), prefix.end());
 	sourceSequence_ = iteration;
-	msg_ = QString(msg.c_str()).toHtmlEscaped();
+	message_.assign(msg.begin(), msg.end());
+	text_valid_ = false;
 }
 
-void qt_mf_msg::updateText()
+void qt_mf_msg::buildText_() const
 {
 	text_ = QString("<font color=");
 
-	QString sev_name = "Error";
 	switch (sev_)
 	{
 		case SDEBUG:
 			text_ += QString("#505050>");
-			color_.setRgb(80, 80, 80);
-			sev_name = "Debug";
 			break;
 
 		case SINFO:
 			text_ += QString("#008000>");
-			color_.setRgb(0, 128, 0);
-			sev_name = "Info";
 			break;
 
 		case SWARNING:
 			text_ += QString("#E08000>");
-			color_.setRgb(224, 128, 0);
-			sev_name = "Warning";
 			break;
 
 		case SERROR:
 			text_ += QString("#FF0000>");
-			color_.setRgb(255, 0, 0);
-			sev_name = "Error";
 			break;
 
 		default:
 			break;
 	}
 
-	shortText_ = text_ + "<pre style=\"margin-top: 0; margin-bottom: 0;\">" + msg_ + "</pre></font>";
+	QString msg = escaped(message_);
+	shortText_ = text_ + "<pre style=\"margin-top: 0; margin-bottom: 0;\">" + msg + "</pre></font>";
 
 	size_t constexpr SIZE{144};
 	struct tm timebuf;
 	char ts[SIZE];
 	strftime(ts, sizeof(ts), "%d-%b-%Y %H:%M:%S %Z", localtime_r(&time_.tv_sec, &timebuf));
 
-	text_ += QString("<pre style=\"width: 100%;\">") + sev_name + " / " + cat_.toHtmlEscaped() + "<br>" +
-	         QString(ts).toHtmlEscaped() + "<br>" + host_.toHtmlEscaped() + " (" + hostaddr_ + ")<br>" + sourceType_ +
-	         " " + QString::number(sourceSequence_) + " / " + "PID " + pid_;
+	text_ += QString("<pre style=\"width: 100%;\">") + severity_name(sev_) + " / " + escaped(cat_) + "<br>" +
+	         QString(ts).toHtmlEscaped() + "<br>" + escaped(host_) + " (" + escaped(hostaddr_) + ")<br>" +
+	         escaped(sourceType_) + " " + QString::number(sourceSequence_) + " / " + "PID " + QString::number(pid_);
+
+	if (file_ != 0) text_ += QString(" / ") + escaped(file_) + ":" + escaped(line_);
+
+	text_ += QString("<br>") + escaped(application_) + " / " + escaped(module_) + " / " + escaped(eventID_) +
+	         "<br>" + msg + "</pre></font>";
+
+	text_valid_ = true;
+}
+
+QString qt_mf_msg::plainText(bool mode) const
+{
+	auto body = QString::fromUtf8(message_.data(), static_cast<int>(message_.size()));
+	if (mode) return body;
 
-	if (file_ != "") text_ += QString(" / ") + file_ + ":" + line_;
+	size_t constexpr SIZE{144};
+	struct tm timebuf;
+	char ts[SIZE];
+	strftime(ts, sizeof(ts), "%d-%b-%Y %H:%M:%S %Z", localtime_r(&time_.tv_sec, &timebuf));
 
-	text_ += QString("<br>") + application_ + " / " + module_ + " / " + eventID_ + "<br>" + msg_ + "</pre></font>";
+	auto text = severity_name(sev_) + " / " + strings()[cat_] + "\n" + ts + "\n" + strings()[host_] + " (" + strings()[hostaddr_] +
+	            ")\n" + QString::fromUtf8(sourceType_.data(), static_cast<int>(sourceType_.size())) + " " +
+	            QString::number(sourceSequence_) + " / PID " + QString::number(pid_);
+	if (file_ != 0) text += " / " + strings()[file_] + ":" + QString::fromUtf8(line_.data(), static_cast<int>(line_.size()));
+	text += "\n" + strings()[application_] + " / " + strings()[module_] + " / " +
+	        QString::fromUtf8(eventID_.data(), static_cast<int>(eventID_.size())) + "\n" + body;
+	return text;
 }
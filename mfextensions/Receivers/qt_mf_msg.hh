@@ -11,28 +11,34 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <sys/time.h>
 #include "messagefacility/Utilities/ELseverityLevel.h"
+#include "mfextensions/Receivers/detail/InternTable.hh"
+#include "mfextensions/Receivers/detail/PoolAllocator.hh"
+#include "mfextensions/Receivers/mf_msg.hh"
 
 namespace mf {
 class ErrorObj;
 }
 
 /// <summary>
-/// Severity codes enumeration for internal use
+/// Handle to a string interned in qt_mf_msg::strings(). Equal handles mean equal strings.
 /// </summary>
-enum sev_code_t
-{
-	SDEBUG,
-	SINFO,
-	SWARNING,
-	SERROR
-};
+typedef mfviewer::detail::InternTable<QString>::id_t str_id_t;
 
 /// <summary>
 /// Qt wrapper around MessageFacility message
+///
+/// The fields are kept as received, in UTF-8. Fields with few distinct values (host, category, application,
+/// module, host address and file) are interned, so that each message only holds a handle to them; the others, and
+/// messages created with create(), are allocated from the shared size-class pools (see detail::PoolAllocator), so
+/// that a long-running viewer reuses the same memory instead of fragmenting the heap. The HTML forms of the message are only built, and then cached,
+/// when text() is first called, so that messages which are suppressed, throttled or trimmed before they are
+/// displayed never pay for them. Like the Qt widgets displaying it, a qt_mf_msg must only be used from one
+/// thread at a time.
 /// </summary>
 class qt_mf_msg
 {
@@ -47,8 +53,15 @@ public:
 	/// <param name="time">Timestamp of the message</param>
 	qt_mf_msg(const std::string& hostname, const std::string& category, const std::string& application, pid_t pid, timeval time);
 
+	/// <summary>
+	/// Construct a qt_mf_msg from a message decoded by a receiver
+	/// </summary>
+	/// <param name="msg">Received message; its fields are copied into the interned and pooled storage</param>
+	explicit qt_mf_msg(mf_msg const& msg);
+
 	/// Default message constructor
-	qt_mf_msg() {}
+	qt_mf_msg()
+	    : host_(0), cat_(0), app_(0), application_(0), module_(0), hostaddr_(0), file_(0), sev_(SERROR), pid_(0), time_({0, 0}), sourceSequence_(0), seq_(mf_msg::next_sequence()), text_valid_(false) {}
 	/// Default copy constructor
 	qt_mf_msg(const qt_mf_msg&) = default;
 	qt_mf_msg(qt_mf_msg&&) = default;                  ///< Default Move Constructor
@@ -59,16 +72,26 @@ public:
 
 	// get method
 	/// <summary>
-	/// Get the text of the message
+	/// Get the text of the message, as HTML. Built on first use.
+	/// </summary>
+	/// <param name="mode">Whether to return the short-form text</param>
+	/// <returns>Text of the message</returns>
+	QString const& text(bool mode) const
+	{
+		if (!text_valid_) buildText_();
+		return mode ? shortText_ : text_;
+	}
+	/// <summary>
+	/// Get the text of the message as plain text, in the same lines as text(). Built on every call.
 	/// </summary>
 	/// <param name="mode">Whether to return the short-form text</param>
 	/// <returns>Text of the message</returns>
-	QString const& text(bool mode) const { return mode ? shortText_ : text_; }
+	QString plainText(bool mode) const;
 	/// <summary>
 	/// Get the severity-based color of the message
 	/// </summary>
 	/// <returns>Color of the message</returns>
-	QColor const& color() const { return color_; }
+	QColor const& color() const;
 	/// <summary>
 	/// Get the severity of the message
 	/// </summary>
@@ -78,38 +101,104 @@ public:
 	/// Get the host from which the message came
 	/// </summary>
 	/// <returns>Hostname of message</returns>
-	QString const& host() const { return host_; }
+	QString const& host() const { return strings()[host_]; }
 	/// <summary>
 	/// Get the category of the message
 	/// </summary>
 	/// <returns>Message category</returns>
-	QString const& cat() const { return cat_; }
+	QString const& cat() const { return strings()[cat_]; }
 	/// <summary>
 	/// Get the application of the message
 	/// </summary>
-	/// <returns>Message application</returns>
-	QString const& app() const { return app_; }
+	/// <returns>Message application, with the PID</returns>
+	QString const& app() const { return strings()[app_]; }
 	/// <summary>
 	/// Get the message timestamp
 	/// </summary>
 	/// <returns>Timestamp of the message</returns>
 	timeval time() const { return time_; }
 	/// <summary>
-	/// Get the sequence number of the message
+	/// Get the sequence number of the message, unique in this process (see mf_msg::next_sequence)
 	/// </summary>
 	/// <returns>Message sequence number</returns>
 	size_t seq() const { return seq_; }
+	/// <summary>
+	/// Get the handle of the host from which the message came
+	/// </summary>
+	/// <returns>Interned host()</returns>
+	str_id_t hostId() const { return host_; }
+	/// <summary>
+	/// Get the handle of the category of the message
+	/// </summary>
+	/// <returns>Interned cat()</returns>
+	str_id_t catId() const { return cat_; }
+	/// <summary>
+	/// Get the handle of the application of the message
+	/// </summary>
+	/// <returns>Interned app()</returns>
+	str_id_t appId() const { return app_; }
+	/// <summary>
+	/// Get the host from which the message came, as received
+	/// </summary>
+	/// <returns>Hostname of message</returns>
+	std::string const& hostname() const { return strings().key(host_); }
+	/// <summary>
+	/// Get the category of the message, as received
+	/// </summary>
+	/// <returns>Message category</returns>
+	std::string const& category() const { return strings().key(cat_); }
+	/// <summary>
+	/// Get the application of the message, as received
+	/// </summary>
+	/// <returns>Message application, without the PID</returns>
+	std::string const& application() const { return strings().key(application_); }
+	/// <summary>
+	/// Get the body of the message as plain text
+	/// </summary>
+	/// <returns>Message text</returns>
+	std::string_view body() const { return message_; }
+
+	/// <summary>
+	/// The table of interned fields, shared by all messages. Handle 0 is the empty string.
+	/// </summary>
+	/// <returns>Table of strings, with their QString forms</returns>
+	static mfviewer::detail::InternTable<QString>& strings();
+
+	/// <summary>
+	/// Intern a string in strings()
+	/// </summary>
+	/// <param name="str">String to intern</param>
+	/// <returns>Handle of the string</returns>
+	static str_id_t intern(std::string const& str);
+
+	/// <summary>
+	/// Allocate a message from the shared pools
+	/// </summary>
+	/// <param name="msg">Received message</param>
+	/// <returns>New message</returns>
+	static std::shared_ptr<qt_mf_msg> create(mf_msg const& msg);
+
+	/// <summary>
+	/// Set aside pool memory for the given number of messages created with create(), e.g. the viewer's message
+	/// buffer size, so that filling the buffer does not allocate memory for the messages themselves
+	/// </summary>
+	/// <param name="count">Number of messages</param>
+	static void reserve(size_t count);
 
 	/// <summary>
 	/// Set the Severity of the message (MF levels)
 	/// </summary>
 	/// <param name="sev">Severity level of the message</param>
-	void setSeverity(mf::ELseverityLevel sev);
+	void setSeverity(mf::ELseverityLevel sev) { setSeverityLevel(mf_msg::severity_code(sev)); }
 	/// <summary>
 	/// Set the severity code of the message (Viewer levels)
 	/// </summary>
 	/// <param name="sev">Severity code of the message</param>
-	void setSeverityLevel(sev_code_t sev) { sev_ = sev; }
+	void setSeverityLevel(sev_code_t sev)
+	{
+		sev_ = sev;
+		text_valid_ = false;
+	}
 	/// <summary>
 	/// Set the message
 	/// </summary>
@@ -121,55 +210,66 @@ public:
 	/// Set the hostaddr field
 	/// </summary>
 	/// <param name="hostaddr">Host address of message source</param>
-	void setHostAddr(std::string const& hostaddr) { hostaddr_ = QString(hostaddr.c_str()).toHtmlEscaped(); }
+	void setHostAddr(std::string const& hostaddr) { setField_(hostaddr_, intern(hostaddr)); }
 	/// <summary>
 	/// Set the file name field
 	/// </summary>
 	/// <param name="file">File generating message</param>
-	void setFileName(std::string const& file) { file_ = QString(file.c_str()).toHtmlEscaped(); }
+	void setFileName(std::string const& file) { setField_(file_, intern(file)); }
 	/// <summary>
 	/// Set the line number field
 	/// </summary>
 	/// <param name="line">Line number in file</param>
-	void setLineNumber(std::string const& line) { line_ = QString(line.c_str()).toHtmlEscaped(); }
+	void setLineNumber(std::string const& line) { setField_(line_, pooled_string_t(line.begin(), line.end())); }
 	/// <summary>
 	/// Set the module name
 	/// </summary>
 	/// <param name="module">Module generating message</param>
-	void setModule(std::string const& module) { module_ = QString(module.c_str()).toHtmlEscaped(); }
+	void setModule(std::string const& module) { setField_(module_, intern(module)); }
 	/// <summary>
 	/// Set the Event ID of the message
 	/// </summary>
 	/// <param name="eventID">Event ID to set</param>
-	void setEventID(std::string const& eventID) { eventID_ = QString(eventID.c_str()).toHtmlEscaped(); }
+	void setEventID(std::string const& eventID) { setField_(eventID_, pooled_string_t(eventID.begin(), eventID.end())); }
 
 	/// <summary>
-	/// Parse fields and create HTML string representing message
+	/// Discard the HTML text, so that it is rebuilt from the current fields when next needed
 	/// </summary>
-	void updateText();
+	void updateText() { text_valid_ = false; }
 
 private:
-	QString text_;
-	QString shortText_;
-	QColor color_;
+	template<typename T>
+	void setField_(T& field, T const& value)
+	{
+		field = value;
+		text_valid_ = false;
+	}
+
+	// Build text_ and shortText_ from the fields
+	void buildText_() const;
+
+	str_id_t host_;         // interned hostname
+	str_id_t cat_;          // interned category
+	str_id_t app_;          // interned "application (pid)"
+	str_id_t application_;  // interned application
+	str_id_t module_;
+	str_id_t hostaddr_;
+	str_id_t file_;
 	sev_code_t sev_;
-	QString host_;
-	QString cat_;
-	QString app_;
+	pid_t pid_;
 	timeval time_;
-	size_t seq_;
-	static size_t sequence;
-
-	QString msg_;
-	QString application_;
-	QString pid_;
-	QString hostaddr_;
-	QString file_;
-	QString line_;
-	QString module_;
-	QString eventID_;
-	QString sourceType_;
 	int sourceSequence_;
+	size_t seq_;
+	typedef mfviewer::detail::pooled_string pooled_string_t;
+	pooled_string_t line_;
+	pooled_string_t eventID_;
+	pooled_string_t sourceType_;
+	pooled_string_t message_;
+
+	// HTML forms, valid once text_valid_ is set
+	mutable QString text_;
+	mutable QString shortText_;
+	mutable bool text_valid_;
 };
 
 /// <summary>
@@ -178,13 +278,13 @@ private:
 typedef std::shared_ptr<qt_mf_msg> msg_ptr_t;
 
 /// <summary>
-/// A std::list of msg_ptr_t
+/// A batch of messages delivered together
 /// </summary>
-typedef std::list<msg_ptr_t> msgs_t;
+typedef std::vector<msg_ptr_t> msg_batch_t;
 
 /// <summary>
-/// A std::map relating a QString and a msgs_t
+/// A std::list of msg_ptr_t
 /// </summary>
-typedef std::map<QString, msgs_t> msgs_map_t;
+typedef std::list<msg_ptr_t> msgs_t;
 
 #endif
@@ -0,0 +1,180 @@
+#include "mfextensions/Destinations/detail/UDPTextFormat.hh"
+
+#define BOOST_TEST_MODULE UDPTextFormat_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "UDPTextFormat_t"
+#include "TRACE/tracemf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <new>
+#include <sstream>
+
+// Count every heap allocation made by this test, so the benchmark can report allocations per message
+static std::atomic<size_t> allocations{0};
+
+// Not inlined, so that the compiler does not pair these with its built-in knowledge of malloc/free
+__attribute__((noinline)) void* operator new(size_t size)
+{
+	++allocations;
+	void* ptr = std::malloc(size == 0 ? 1 : size);  // NOLINT(cppcoreguidelines-no-malloc)
+	if (ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+__attribute__((noinline)) void operator delete(void* ptr) noexcept { std::free(ptr); }               // NOLINT(cppcoreguidelines-no-malloc)
+__attribute__((noinline)) void operator delete(void* ptr, size_t /*size*/) noexcept { std::free(ptr); }  // NOLINT(cppcoreguidelines-no-malloc)
+
+using mfplugins::detail::UDPTextFormatter;
+
+namespace {
+struct Message
+{
+	std::string timestamp = "17-Oct-2026 10:11:12 UTC";
+	std::string severity = "INFO";
+	std::string category = "EventBuilder|eb01";
+	std::string iteration = "Run 1, Event 2";
+	std::string module = "BuildInfo";
+	std::string filename = "/home/daq/srcs/artdaq/artdaq/DAQrate/DataSenderManager.cc";
+	int line = 123;
+	std::list<std::string> items{"\n", "Received fragment ", "42", " from board ", "7"};
+};
+
+// The formatting done by ELUDP before it used UDPTextFormatter, kept as the benchmark baseline
+std::string legacy_format(Message const& msg, int seqNum, std::string const& hostname, std::string const& hostaddr,
+                          std::string const& app_, int64_t pid_, std::string const& filename_delimit_)
+{
+	std::ostringstream oss;
+
+	auto id = msg.category;
+	auto module = msg.module;
+	auto app = app_;
+	std::replace(id.begin(), id.end(), '|', '!');
+	std::replace(app.begin(), app.end(), '|', '!');
+	std::replace(module.begin(), module.end(), '|', '!');
+
+	oss << msg.timestamp << "|";
+	oss << std::to_string(seqNum) << "|";
+	oss << hostname << "|";
+	oss << hostaddr << "|";
+	oss << msg.severity << "|";
+	oss << id << "|";
+	oss << app << "|";
+	oss << pid_ << "|";
+	oss << msg.iteration << "|";
+	oss << module << "|";
+	const char* cp = strrchr(msg.filename.c_str(), filename_delimit_[0]);
+	oss << (cp != nullptr ? cp + 1 : msg.filename.c_str());  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+	oss << "|" << std::to_string(msg.line) << "|";
+
+	std::ostringstream tmposs;
+	for (auto const& val : msg.items)
+	{
+		tmposs << val;
+	}
+	const std::string& usrMsg = tmposs.str().compare(0, 1, "\n") == 0 ? tmposs.str().erase(0, 1) : tmposs.str();
+	oss << usrMsg;
+
+	return "UDPMFMESSAGE" + std::to_string(pid_) + "|" + oss.str();
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(UDPTextFormat_t)
+
+BOOST_AUTO_TEST_CASE(MatchesLegacyFormat)
+{
+	Message msg;
+	UDPTextFormatter formatter("daq01.fnal.gov", "131.225.0.1", "boardreader|1", 4242, "/");
+
+	std::string payload;
+	formatter.format_prefix(payload, msg.timestamp, 17, msg.severity, msg.category, msg.iteration, msg.module,
+	                        msg.filename, msg.line);
+	UDPTextFormatter::append_body(payload, msg.items);
+
+	BOOST_REQUIRE_EQUAL(payload, legacy_format(msg, 17, "daq01.fnal.gov", "131.225.0.1", "boardreader|1", 4242, "/"));
+	BOOST_REQUIRE_EQUAL(payload,
+	                    "UDPMFMESSAGE4242|17-Oct-2026 10:11:12 UTC|17|daq01.fnal.gov|131.225.0.1|INFO|EventBuilder!eb01|"
+	                    "boardreader!1|4242|Run 1, Event 2|BuildInfo|DataSenderManager.cc|123|Received fragment 42 from board 7");
+}
+
+BOOST_AUTO_TEST_CASE(TrimFilename)
+{
+	std::string const path = "/home/daq/srcs/artdaq/artdaq/DAQrate/DataSenderManager.cc";
+
+	UDPTextFormatter none("h", "a", "app", 1, "");
+	BOOST_REQUIRE(none.trim_filename(path) == path);
+
+	UDPTextFormatter slash("h", "a", "app", 1, "/");
+	BOOST_REQUIRE(slash.trim_filename(path) == "DataSenderManager.cc");
+	BOOST_REQUIRE(slash.trim_filename("plain.cc") == "plain.cc");
+
+	UDPTextFormatter srcs("h", "a", "app", 1, "/srcs/");
+	BOOST_REQUIRE(srcs.trim_filename(path) == "artdaq/artdaq/DAQrate/DataSenderManager.cc");
+	BOOST_REQUIRE(srcs.trim_filename(path) == "artdaq/artdaq/DAQrate/DataSenderManager.cc");  // cached
+	BOOST_REQUIRE(srcs.trim_filename("/opt/other/file.cc") == "/opt/other/file.cc");
+
+	// A delimiter not ending in '/' extends to the next path component
+	UDPTextFormatter partial("h", "a", "app", 1, "/sr");
+	BOOST_REQUIRE(partial.trim_filename(path) == "artdaq/artdaq/DAQrate/DataSenderManager.cc");
+	BOOST_REQUIRE(partial.trim_filename("/x/srcfile").empty());
+}
+
+BOOST_AUTO_TEST_CASE(AppendBody)
+{
+	std::string out;
+	UDPTextFormatter::append_body(out, std::list<std::string>{"", "\nfirst\n", "second"});
+	BOOST_REQUIRE_EQUAL(out, "first\nsecond");
+
+	out.clear();
+	UDPTextFormatter::append_body(out, std::list<std::string>{"no newline"});
+	BOOST_REQUIRE_EQUAL(out, "no newline");
+}
+
+// Only the formatting is measured. ELUDP still allocates around it for every message: messagefacility returns the
+// timestamp and iteration as new strings, and in async mode the send queue takes its own copy of the datagram.
+BOOST_AUTO_TEST_CASE(AllocationBenchmark)
+{
+	const int iterations = 100000;
+	Message msg;
+
+	auto start = std::chrono::steady_clock::now();
+	size_t before = allocations;
+	size_t bytes = 0;
+	for (int ii = 0; ii < iterations; ++ii)
+	{
+		bytes += legacy_format(msg, ii, "daq01.fnal.gov", "131.225.0.1", "boardreader", 4242, "/").size();
+	}
+	double legacy_allocs = static_cast<double>(allocations - before) / iterations;
+	auto legacy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+	UDPTextFormatter formatter("daq01.fnal.gov", "131.225.0.1", "boardreader", 4242, "/");
+	std::string payload;
+	formatter.format_prefix(payload, msg.timestamp, 0, msg.severity, msg.category, msg.iteration, msg.module,
+	                        msg.filename, msg.line);
+	UDPTextFormatter::append_body(payload, msg.items);  // warm up the buffer
+
+	start = std::chrono::steady_clock::now();
+	before = allocations;
+	for (int ii = 0; ii < iterations; ++ii)
+	{
+		formatter.format_prefix(payload, msg.timestamp, ii, msg.severity, msg.category, msg.iteration, msg.module,
+		                        msg.filename, msg.line);
+		UDPTextFormatter::append_body(payload, msg.items);
+		bytes += payload.size();
+	}
+	double new_allocs = static_cast<double>(allocations - before) / iterations;
+	auto new_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+	TLOG(TLVL_INFO) << "Text formatting alone, per message: legacy " << legacy_allocs << " allocations, " << legacy_ns
+	                << " ns; UDPTextFormatter " << new_allocs << " allocations, " << new_ns << " ns (" << bytes << " bytes)";
+
+	BOOST_REQUIRE_EQUAL(new_allocs, 0.0);
+	BOOST_REQUIRE_GT(legacy_allocs, 0.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+#include "mfextensions/Destinations/detail/WritableWaiter.hh"
+
+#define BOOST_TEST_MODULE WritableWaiter_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "WritableWaiter_t"
+#include "TRACE/tracemf.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using mfplugins::detail::WritableWaiter;
+
+namespace {
+
+// A connected pair of non-blocking datagram sockets. Unlike UDP over loopback, a Unix socket stops accepting
+// datagrams when its peer does not read, so the send buffer can be filled on demand.
+struct SocketPair
+{
+	int fds[2] = {-1, -1};
+	SocketPair() { BOOST_REQUIRE_EQUAL(socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, fds), 0); }
+	~SocketPair()
+	{
+		close(fds[0]);
+		close(fds[1]);
+	}
+
+	// Send datagrams until the socket refuses them
+	size_t fill() const
+	{
+		std::string payload(512, 'x');
+		size_t count = 0;
+		while (send(fds[0], payload.data(), payload.size(), 0) >= 0) ++count;
+		BOOST_REQUIRE(errno == EAGAIN || errno == EWOULDBLOCK);
+		return count;
+	}
+};
+
+// The async send path of ELUDP in miniature: a sender thread flushes a queue through a non-blocking socket, and the
+// destructor drains whatever is still queued before joining it
+class Destination
+{
+public:
+	// sent and dropped count the queued messages, and are final once the destination has been destroyed
+	Destination(int fd, std::chrono::milliseconds wait_timeout, std::chrono::milliseconds drain_timeout, size_t& sent, size_t& dropped)
+	    : fd_(fd), writable_(wait_timeout, drain_timeout), stop_(false), sent_(sent), dropped_(dropped), thread_([this] { loop_(); }) {}
+
+	~Destination()
+	{
+		{
+			std::lock_guard<std::mutex> lk(mutex_);
+			writable_.start_drain();
+			stop_ = true;
+		}
+		cv_.notify_all();
+		thread_.join();
+	}
+
+	void enqueue(std::string payload)
+	{
+		std::lock_guard<std::mutex> lk(mutex_);
+		queue_.push_back(std::move(payload));
+		cv_.notify_all();
+	}
+
+private:
+	void loop_()
+	{
+		// Queued messages are only sent once the destination is being destroyed, so that all of them meet the full buffer
+		std::unique_lock<std::mutex> lk(mutex_);
+		cv_.wait(lk, [this] { return stop_; });
+		for (auto const& payload : queue_)
+		{
+			auto sts = send(fd_, payload.data(), payload.size(), 0);
+			while (sts < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && writable_.wait(fd_))
+			{
+				sts = send(fd_, payload.data(), payload.size(), 0);
+			}
+			++(sts >= 0 ? sent_ : dropped_);
+		}
+	}
+
+	int fd_;
+	WritableWaiter writable_;
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::deque<std::string> queue_;
+	bool stop_;
+	size_t& sent_;
+	size_t& dropped_;
+	std::thread thread_;
+};
+
+size_t drain_reader(int fd)
+{
+	char buf[1024];
+	size_t count = 0;
+	while (recv(fd, buf, sizeof(buf), 0) >= 0) ++count;  // NOLINT(cppcoreguidelines-pro-bounds-array-to-pointer-decay)
+	return count;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(WritableWaiter_t)
+
+BOOST_AUTO_TEST_CASE(WaitTimesOut)
+{
+	SocketPair sockets;
+	sockets.fill();
+
+	WritableWaiter waiter(std::chrono::milliseconds(20), std::chrono::milliseconds(5000));
+	BOOST_REQUIRE(!waiter.draining());
+	auto start = std::chrono::steady_clock::now();
+	BOOST_REQUIRE(!waiter.wait(sockets.fds[0]));
+	BOOST_REQUIRE_EQUAL(errno, EAGAIN);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	BOOST_REQUIRE(elapsed >= std::chrono::milliseconds(15));
+	BOOST_REQUIRE(elapsed < std::chrono::milliseconds(2000));
+
+	// Room in the buffer ends the wait at once
+	drain_reader(sockets.fds[1]);
+	BOOST_REQUIRE(waiter.wait(sockets.fds[0]));
+}
+
+BOOST_AUTO_TEST_CASE(DrainRetriesFullBuffer)
+{
+	SocketPair sockets;
+	auto capacity = sockets.fill();
+	constexpr size_t queued = 50;
+
+	// The reader only starts after several per-message wait timeouts have gone by
+	std::atomic<size_t> received{0};
+	std::atomic<bool> done{false};
+	std::thread reader([&] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		while (!done)
+		{
+			received += drain_reader(sockets.fds[1]);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		received += drain_reader(sockets.fds[1]);
+	});
+
+	size_t sent = 0;
+	size_t dropped = 0;
+	{
+		Destination dest(sockets.fds[0], std::chrono::milliseconds(20), std::chrono::milliseconds(5000), sent, dropped);
+		for (size_t ii = 0; ii < queued; ++ii) dest.enqueue("queued message " + std::to_string(ii));
+		// Destroying the destination drains the queue into the full socket
+	}
+	done = true;
+	reader.join();
+
+	TLOG(TLVL_INFO) << "Socket held " << capacity << " datagrams; received " << received << " after the drain";
+	BOOST_REQUIRE_EQUAL(sent, queued);
+	BOOST_REQUIRE_EQUAL(dropped, 0);
+	BOOST_REQUIRE_EQUAL(received.load(), capacity + queued);
+}
+
+BOOST_AUTO_TEST_CASE(DrainDeadlineIsShared)
+{
+	SocketPair sockets;
+	sockets.fill();
+	constexpr size_t queued = 20;
+
+	auto start = std::chrono::steady_clock::now();
+	size_t sent = 0;
+	size_t dropped = 0;
+	{
+		// Nobody reads: bounded one by one, the waits would take queued * 100 ms
+		Destination dest(sockets.fds[0], std::chrono::milliseconds(100), std::chrono::milliseconds(200), sent, dropped);
+		for (size_t ii = 0; ii < queued; ++ii) dest.enqueue("queued message " + std::to_string(ii));
+	}
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	BOOST_REQUIRE_EQUAL(sent, 0);
+	BOOST_REQUIRE_EQUAL(dropped, queued);
+
+	TLOG(TLVL_INFO) << "Drain into a stalled socket took " << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms";
+	BOOST_REQUIRE(elapsed >= std::chrono::milliseconds(190));
+	BOOST_REQUIRE(elapsed < std::chrono::milliseconds(1500));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+#include "mfextensions/Receivers/detail/BlockSequence.hh"
+
+#define BOOST_TEST_MODULE BlockSequence_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "BlockSequence_t"
+#include "TRACE/tracemf.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using mfviewer::detail::BlockSequence;
+
+BOOST_AUTO_TEST_SUITE(BlockSequence_t)
+
+BOOST_AUTO_TEST_CASE(SingleThread)
+{
+	BlockSequence sequence(4);
+	BlockSequence::Block block;
+	for (size_t i = 1; i <= 10; ++i)
+	{
+		BOOST_REQUIRE_EQUAL(sequence.next(block), i);
+	}
+
+	// A second thread starts on a block of its own
+	BlockSequence::Block other;
+	BOOST_REQUIRE_EQUAL(sequence.next(other), 13);
+	BOOST_REQUIRE_EQUAL(sequence.next(block), 11);
+	BOOST_REQUIRE_EQUAL(sequence.next(block), 12);
+	BOOST_REQUIRE_EQUAL(sequence.next(block), 17);
+}
+
+BOOST_AUTO_TEST_CASE(UniqueAcrossThreads)
+{
+	const size_t nThreads = 4;
+	const size_t perThread = 100000;
+	BlockSequence sequence(1024);
+	std::vector<std::vector<size_t>> taken(nThreads);
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < nThreads; ++t)
+	{
+		threads.emplace_back([&, t] {
+			BlockSequence::Block block;
+			taken[t].reserve(perThread);
+			for (size_t i = 0; i < perThread; ++i)
+			{
+				taken[t].push_back(sequence.next(block));
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	std::vector<size_t> all;
+	for (auto const& numbers : taken)
+	{
+		BOOST_REQUIRE(std::is_sorted(numbers.begin(), numbers.end()));
+		all.insert(all.end(), numbers.begin(), numbers.end());
+	}
+	std::sort(all.begin(), all.end());
+	BOOST_REQUIRE(std::adjacent_find(all.begin(), all.end()) == all.end());
+	BOOST_REQUIRE_GE(all.front(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+#include "mfextensions/Receivers/detail/BodyPattern.hh"
+
+#define BOOST_TEST_MODULE BodyPattern_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "BodyPattern_t"
+#include "TRACE/tracemf.h"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+using mfviewer::detail::BodyPattern;
+using mfviewer::detail::find_literal;
+using mfviewer::detail::parallel_select;
+
+BOOST_AUTO_TEST_SUITE(BodyPattern_t)
+
+BOOST_AUTO_TEST_CASE(FindLiteral)
+{
+	// Small alphabet, so partial matches are common, at every alignment and length
+	std::mt19937 gen(23);
+	std::uniform_int_distribution<int> letter('a', 'c');
+	for (int round = 0; round < 20000; ++round)
+	{
+		std::string text(round % 80, ' ');
+		for (auto& c : text) c = static_cast<char>(letter(gen));
+		std::string needle(1 + round % 7, ' ');
+		for (auto& c : needle) c = static_cast<char>(letter(gen));
+		BOOST_REQUIRE_EQUAL(find_literal(text, needle), std::string_view(text).find(needle));
+	}
+	BOOST_REQUIRE_EQUAL(find_literal("abc", ""), 0);
+	BOOST_REQUIRE_EQUAL(find_literal("", "abc"), std::string_view::npos);
+}
+
+BOOST_AUTO_TEST_CASE(Patterns)
+{
+	BodyPattern literal("timeout");
+	BOOST_REQUIRE(literal.literal());
+	BOOST_REQUIRE(literal.matches("Fragment timeout on board 3"));
+	BOOST_REQUIRE(!literal.matches("Fragment Timeout on board 3"));
+
+	BodyPattern regex("board [0-9]+$");
+	BOOST_REQUIRE(!regex.literal());
+	BOOST_REQUIRE(regex.matches("Fragment timeout on board 3"));
+	BOOST_REQUIRE(!regex.matches("board x"));
+
+	BOOST_REQUIRE_THROW(BodyPattern("run (1234"), boost::regex_error);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelSelect)
+{
+	std::vector<std::string> bodies;
+	std::vector<size_t> candidates;
+	for (size_t i = 0; i < 100000; ++i)
+	{
+		bodies.push_back("Run " + std::to_string(i) + (i % 37 == 0 ? ": fragment timeout" : ": event built"));
+		if (i % 3 != 0) candidates.push_back(i);
+	}
+	auto body_at = [&](size_t i) { return std::string_view(bodies[i]); };
+
+	for (std::string pattern : {"timeout", "Run [0-9]*7: event", "no such thing"})
+	{
+		BodyPattern compiled(pattern);
+		std::vector<size_t> expected;
+		for (auto i : candidates)
+		{
+			if (compiled.matches(bodies[i])) expected.push_back(i);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		auto selected = parallel_select(compiled, candidates, body_at);
+		auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		TLOG(TLVL_INFO) << "Selected " << selected.size() << " of " << candidates.size() << " messages with \"" << pattern << "\" in " << elapsed << " ms";
+		BOOST_REQUIRE(selected == expected);
+		BOOST_REQUIRE(parallel_select(compiled, candidates, body_at, 5) == expected);  // however the work is split
+	}
+	BOOST_REQUIRE(parallel_select(BodyPattern("x"), std::vector<size_t>(), body_at).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,173 @@
+#include "mfextensions/Receivers/detail/FragmentReassembler.hh"
+
+#define BOOST_TEST_MODULE FragmentReassembler_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "FragmentReassembler_t"
+#include "TRACE/tracemf.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace mfviewer::detail;
+
+namespace {
+struct Fragment
+{
+	FragmentHeader hdr;
+	std::string data;
+};
+
+std::vector<Fragment> make_fragments(std::string const& payload, uint64_t session, uint32_t message_id, size_t max_size)
+{
+	std::vector<Fragment> out;
+	std::string scratch;
+	split_fragments(payload, session, message_id, max_size, scratch, [&](std::string const& frag) {
+		Fragment f;
+		std::string_view data;
+		decode_fragment(frag.data(), frag.size(), f.hdr, data);
+		f.data = std::string(data);
+		out.push_back(f);
+	});
+	return out;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(FragmentReassembler_t)
+
+BOOST_AUTO_TEST_CASE(OutOfOrder)
+{
+	std::string payload(5000, 'x');
+	payload.replace(0, 5, "start");
+	payload.replace(payload.size() - 3, 3, "end");
+	auto frags = make_fragments(payload, 1, 1, 1000);
+	BOOST_REQUIRE_GT(frags.size(), 2);
+	std::reverse(frags.begin(), frags.end());
+
+	FragmentReassembler reassembler(8, 1 << 20, 1 << 24, std::chrono::milliseconds(1000));
+	auto now = FragmentReassembler::clock::now();
+	std::string complete;
+	for (size_t ii = 0; ii + 1 < frags.size(); ++ii)
+	{
+		BOOST_REQUIRE(!reassembler.add(frags[ii].hdr, frags[ii].data, now, complete));
+	}
+	BOOST_REQUIRE_EQUAL(reassembler.pending(), 1);
+
+	// A repeated fragment is counted and ignored
+	BOOST_REQUIRE(!reassembler.add(frags[0].hdr, frags[0].data, now, complete));
+	BOOST_REQUIRE_EQUAL(reassembler.stats().duplicates, 1);
+
+	BOOST_REQUIRE(reassembler.add(frags.back().hdr, frags.back().data, now, complete));
+	BOOST_REQUIRE_EQUAL(complete, payload);
+	BOOST_REQUIRE_EQUAL(reassembler.pending(), 0);
+	BOOST_REQUIRE_EQUAL(reassembler.stats().completed, 1);
+}
+
+BOOST_AUTO_TEST_CASE(InterleavedSenders)
+{
+	std::string first(3000, '1');
+	std::string second(3000, '2');
+	auto a = make_fragments(first, 1, 7, 1000);
+	auto b = make_fragments(second, 2, 7, 1000);  // Same message id, different session
+	BOOST_REQUIRE_EQUAL(a.size(), b.size());
+
+	FragmentReassembler reassembler(8, 1 << 20, 1 << 24, std::chrono::milliseconds(1000));
+	auto now = FragmentReassembler::clock::now();
+	std::string complete;
+	std::vector<std::string> done;
+	for (size_t ii = 0; ii < a.size(); ++ii)
+	{
+		if (reassembler.add(a[ii].hdr, a[ii].data, now, complete)) done.push_back(complete);
+		if (reassembler.add(b[ii].hdr, b[ii].data, now, complete)) done.push_back(complete);
+	}
+	BOOST_REQUIRE_EQUAL(done.size(), 2);
+	BOOST_REQUIRE_EQUAL(done[0], first);
+	BOOST_REQUIRE_EQUAL(done[1], second);
+}
+
+BOOST_AUTO_TEST_CASE(TimeoutAndEviction)
+{
+	FragmentReassembler reassembler(2, 1 << 20, 1 << 24, std::chrono::milliseconds(100));
+	auto now = FragmentReassembler::clock::now();
+	std::string complete;
+
+	for (uint32_t id = 0; id < 3; ++id)
+	{
+		auto frags = make_fragments(std::string(2500, 'y'), 1, id, 1000);
+		BOOST_REQUIRE(!reassembler.add(frags[0].hdr, frags[0].data, now + std::chrono::milliseconds(id), complete));
+	}
+	// The table holds two partial messages; the oldest was evicted to make room for the third
+	BOOST_REQUIRE_EQUAL(reassembler.pending(), 2);
+	BOOST_REQUIRE_EQUAL(reassembler.stats().incomplete, 1);
+
+	BOOST_REQUIRE_EQUAL(reassembler.expire(now + std::chrono::milliseconds(50)), 0);
+	BOOST_REQUIRE_EQUAL(reassembler.expire(now + std::chrono::milliseconds(500)), 2);
+	BOOST_REQUIRE_EQUAL(reassembler.pending(), 0);
+	BOOST_REQUIRE_EQUAL(reassembler.stats().incomplete, 3);
+	BOOST_REQUIRE_EQUAL(reassembler.stats().completed, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Rejected)
+{
+	FragmentReassembler reassembler(8, 2000, 1 << 24, std::chrono::milliseconds(1000));
+	auto now = FragmentReassembler::clock::now();
+	std::string complete;
+
+	auto big = make_fragments(std::string(5000, 'z'), 1, 1, 1000);
+	BOOST_REQUIRE(!reassembler.add(big[0].hdr, big[0].data, now, complete));
+	BOOST_REQUIRE_EQUAL(reassembler.stats().rejected, 1);
+	BOOST_REQUIRE_EQUAL(reassembler.pending(), 0);
+
+	// A fragment disagreeing with earlier ones about the payload size is ignored
+	auto frags = make_fragments(std::string(1500, 'z'), 1, 2, 1000);
+	BOOST_REQUIRE(!reassembler.add(frags[0].hdr, frags[0].data, now, complete));
+	auto hdr = frags[1].hdr;
+	hdr.total_length -= 1;
+	BOOST_REQUIRE(!reassembler.add(hdr, frags[1].data.substr(1), now, complete));
+	BOOST_REQUIRE_EQUAL(reassembler.stats().rejected, 2);
+	BOOST_REQUIRE(reassembler.add(frags[1].hdr, frags[1].data, now, complete));
+	BOOST_REQUIRE_EQUAL(complete, std::string(1500, 'z'));
+}
+
+BOOST_AUTO_TEST_CASE(ByteBudget)
+{
+	auto now = FragmentReassembler::clock::now();
+	std::string complete;
+
+	// First fragments claiming large payloads only hold the bytes they carry
+	FragmentReassembler lazy(256, 16 << 20, 1 << 24, std::chrono::milliseconds(1000));
+	for (uint32_t id = 0; id < 256; ++id)
+	{
+		auto hdr = make_fragments(std::string(2000, 'f'), 7, id, 1000)[0].hdr;
+		hdr.total_length = 16 << 20;
+		hdr.count = UINT16_MAX;
+		BOOST_REQUIRE(!lazy.add(hdr, "forged", now + std::chrono::milliseconds(id), complete));
+	}
+	BOOST_REQUIRE_EQUAL(lazy.pending(), 256);
+	BOOST_REQUIRE_EQUAL(lazy.pending_bytes(), 256 * 6);
+
+	// Payloads which together go over budget push out the oldest
+	FragmentReassembler reassembler(8, 1 << 20, 3500, std::chrono::milliseconds(1000));
+	auto a = make_fragments(std::string(3000, 'a'), 1, 1, 1000);
+	auto b = make_fragments(std::string(3000, 'b'), 1, 2, 1000);
+	BOOST_REQUIRE(!reassembler.add(a[0].hdr, a[0].data, now, complete));
+	BOOST_REQUIRE(!reassembler.add(a[1].hdr, a[1].data, now, complete));
+	for (size_t ii = 0; ii + 1 < b.size(); ++ii)
+	{
+		BOOST_REQUIRE(!reassembler.add(b[ii].hdr, b[ii].data, now + std::chrono::milliseconds(1), complete));
+		BOOST_REQUIRE_LE(reassembler.pending_bytes(), 3500);
+	}
+	BOOST_REQUIRE_EQUAL(reassembler.stats().incomplete, 1);
+	BOOST_REQUIRE_EQUAL(reassembler.pending(), 1);
+	BOOST_REQUIRE(reassembler.add(b.back().hdr, b.back().data, now, complete));
+	BOOST_REQUIRE_EQUAL(complete, std::string(3000, 'b'));
+	BOOST_REQUIRE_EQUAL(reassembler.pending(), 0);
+	BOOST_REQUIRE_EQUAL(reassembler.pending_bytes(), 0);
+
+	// A payload larger than the whole budget is never started
+	BOOST_REQUIRE(!reassembler.add(make_fragments(std::string(6000, 'c'), 1, 3, 1000)[0].hdr, "c", now, complete));
+	BOOST_REQUIRE_EQUAL(reassembler.stats().rejected, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+#include "mfextensions/Receivers/detail/InternTable.hh"
+
+#define BOOST_TEST_MODULE InternTable_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "InternTable_t"
+#include "TRACE/tracemf.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using mfviewer::detail::InternTable;
+
+namespace {
+size_t length(std::string const& key) { return key.size(); }
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(InternTable_t)
+
+BOOST_AUTO_TEST_CASE(Intern)
+{
+	InternTable<size_t> table;
+	auto host1 = table.intern("host1", length);
+	auto host2 = table.intern("host2.example.org", length);
+	BOOST_REQUIRE_NE(host1, host2);
+	BOOST_REQUIRE_EQUAL(table.intern(std::string("host1"), length), host1);
+	BOOST_REQUIRE_EQUAL(table.size(), 2);
+
+	BOOST_REQUIRE_EQUAL(table.key(host1), "host1");
+	BOOST_REQUIRE_EQUAL(table.key(host2), "host2.example.org");
+	BOOST_REQUIRE_EQUAL(table[host2], 17);
+
+	InternTable<size_t>::id_t id = 0;
+	BOOST_REQUIRE(table.find("host2.example.org", id));
+	BOOST_REQUIRE_EQUAL(id, host2);
+	BOOST_REQUIRE(!table.find("host3", id));
+	BOOST_REQUIRE_EQUAL(table.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(StableAcrossChunks)
+{
+	InternTable<size_t> table;
+	auto first = table.intern("first", length);
+	auto const& key = table.key(first);
+
+	for (size_t i = 0; i < 3 * InternTable<size_t>::chunk_size; ++i)
+	{
+		auto id = table.intern("key" + std::to_string(i), length);
+		BOOST_REQUIRE_EQUAL(id, i + 1);
+	}
+	BOOST_REQUIRE_EQUAL(&table.key(first), &key);
+	BOOST_REQUIRE_EQUAL(table.key(2000), "key1999");
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentIntern)
+{
+	const size_t nThreads = 4;
+	const size_t nKeys = 5000;
+	InternTable<size_t> table;
+	std::vector<std::vector<InternTable<size_t>::id_t>> ids(nThreads);
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < nThreads; ++t)
+	{
+		threads.emplace_back([&, t] {
+			for (size_t i = 0; i < nKeys; ++i)
+			{
+				auto id = table.intern("category" + std::to_string(i % 500) + "/" + std::to_string(i), length);
+				if (table.key(id).empty()) break;  // read back while others are adding entries
+				ids[t].push_back(id);
+			}
+		});
+	}
+	for (auto& thread : threads) thread.join();
+
+	BOOST_REQUIRE_EQUAL(table.size(), nKeys);
+	for (size_t t = 1; t < nThreads; ++t)
+	{
+		BOOST_REQUIRE(ids[t] == ids[0]);
+	}
+	for (size_t i = 0; i < nKeys; ++i)
+	{
+		BOOST_REQUIRE_EQUAL(table.key(ids[0][i]), "category" + std::to_string(i % 500) + "/" + std::to_string(i));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
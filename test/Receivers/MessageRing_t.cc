@@ -0,0 +1,100 @@
+#include "mfextensions/Receivers/detail/MessageRing.hh"
+#include "mfextensions/Receivers/detail/PositionBitmap.hh"
+
+#define BOOST_TEST_MODULE MessageRing_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "MessageRing_t"
+#include "TRACE/tracemf.h"
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+
+using mfviewer::detail::MessageRing;
+using mfviewer::detail::BitmapIndex;
+
+BOOST_AUTO_TEST_SUITE(MessageRing_t)
+
+BOOST_AUTO_TEST_CASE(Ring)
+{
+	MessageRing<std::string> ring(2);
+	BOOST_REQUIRE(ring.empty());
+	BOOST_REQUIRE_EQUAL(ring.push_back("a"), 0);
+	BOOST_REQUIRE_EQUAL(ring.push_back("b"), 1);
+	BOOST_REQUIRE_EQUAL(ring.push_back("c"), 2);  // grows
+	BOOST_REQUIRE_EQUAL(ring.size(), 3);
+	BOOST_REQUIRE_EQUAL(ring[1], "b");
+
+	ring.pop_front();
+	BOOST_REQUIRE(!ring.contains(0));
+	BOOST_REQUIRE(ring.contains(1));
+	BOOST_REQUIRE_EQUAL(ring.front(), "b");
+
+	// Wrap around many times at a steady size
+	for (int i = 0; i < 100; ++i)
+	{
+		auto position = ring.push_back(std::to_string(i));
+		ring.pop_front();
+		BOOST_REQUIRE_EQUAL(ring[position], std::to_string(i));
+		BOOST_REQUIRE_EQUAL(ring.size(), 2);
+	}
+	BOOST_REQUIRE_EQUAL(ring.begin(), 101);
+	BOOST_REQUIRE_EQUAL(ring.end(), 103);
+
+	ring.reserve(100);  // keeps the contents
+	BOOST_REQUIRE_EQUAL(ring[101], "98");
+	BOOST_REQUIRE_EQUAL(ring[102], "99");
+
+	ring.clear();
+	BOOST_REQUIRE(ring.empty());
+	BOOST_REQUIRE(!ring.contains(102));
+	BOOST_REQUIRE_EQUAL(ring.push_back("d"), 103);
+}
+
+BOOST_AUTO_TEST_CASE(ReleasesEvicted)
+{
+	MessageRing<std::shared_ptr<int>> ring(4);
+	auto value = std::make_shared<int>(1);
+	std::weak_ptr<int> watch = value;
+	ring.push_back(std::move(value));
+	ring.pop_front();
+	BOOST_REQUIRE(watch.expired());
+}
+
+BOOST_AUTO_TEST_CASE(EvictionCost)
+{
+	// At the viewer's default buffer size, keeping the pool full must cost the same for every message
+	const size_t capacity = 100000;
+	const size_t total = 1000000;
+	MessageRing<std::shared_ptr<int>> ring(capacity);
+	BitmapIndex<int> hosts;
+	BitmapIndex<int> categories;
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < total; ++i)
+	{
+		auto position = ring.push_back(std::make_shared<int>(static_cast<int>(i)));
+		hosts.add(static_cast<int>(i % 50), position);
+		categories.add(static_cast<int>(i % 300), position);
+		if (ring.size() > capacity)
+		{
+			auto oldest = static_cast<size_t>(*ring.front());
+			hosts.evict(static_cast<int>(oldest % 50), ring.begin());
+			categories.evict(static_cast<int>(oldest % 300), ring.begin());
+			ring.pop_front();
+		}
+	}
+	auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	TLOG(TLVL_INFO) << "Ring with " << capacity << " messages: " << elapsed / total << " us per message added and evicted";
+
+	BOOST_REQUIRE_EQUAL(ring.size(), capacity);
+	size_t indexed = 0;
+	for (auto const& entry : hosts.map()) indexed += entry.second.count;
+	BOOST_REQUIRE_EQUAL(indexed, capacity);
+	BOOST_REQUIRE(hosts.find(static_cast<int>(*ring.front() % 50))->contains(ring.begin()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
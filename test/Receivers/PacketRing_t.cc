@@ -0,0 +1,96 @@
+#include "mfextensions/Receivers/detail/PacketRing.hh"
+
+#define BOOST_TEST_MODULE PacketRing_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "PacketRing_t"
+#include "TRACE/tracemf.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using mfviewer::detail::PacketRing;
+
+BOOST_AUTO_TEST_SUITE(PacketRing_t)
+
+BOOST_AUTO_TEST_CASE(SingleThread)
+{
+	PacketRing ring(4, 16);
+	BOOST_REQUIRE_EQUAL(ring.capacity(), 4);
+	BOOST_REQUIRE_EQUAL(ring.free_slots(), 4);
+	BOOST_REQUIRE_EQUAL(ring.ready(), 0);
+
+	for (size_t ii = 0; ii < 3; ++ii)
+	{
+		auto& slot = ring.write_slot(ii);
+		BOOST_REQUIRE_EQUAL(slot.data.size(), 16);
+		slot.data[0] = static_cast<char>('a' + ii);
+		slot.size = 1;
+	}
+	ring.publish(3);
+	BOOST_REQUIRE_EQUAL(ring.free_slots(), 1);
+	BOOST_REQUIRE_EQUAL(ring.ready(), 3);
+
+	BOOST_REQUIRE_EQUAL(ring.read_slot(0).data[0], 'a');
+	BOOST_REQUIRE_EQUAL(ring.read_slot(2).data[0], 'c');
+	ring.release(2);
+	BOOST_REQUIRE_EQUAL(ring.ready(), 1);
+	BOOST_REQUIRE_EQUAL(ring.free_slots(), 3);
+
+	// Writing wraps around the end of the ring
+	for (size_t ii = 0; ii < 3; ++ii) ring.write_slot(ii).data[0] = static_cast<char>('d' + ii);
+	ring.publish(3);
+	BOOST_REQUIRE_EQUAL(ring.free_slots(), 0);
+	for (size_t ii = 0; ii < 4; ++ii) BOOST_REQUIRE_EQUAL(ring.read_slot(ii).data[0], static_cast<char>('c' + ii));
+	ring.release(4);
+	BOOST_REQUIRE_EQUAL(ring.ready(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ProducerConsumer)
+{
+	const size_t total = 200000;
+	PacketRing ring(64, sizeof(size_t));
+
+	std::thread producer([&] {
+		size_t next = 0;
+		while (next < total)
+		{
+			auto count = std::min(ring.free_slots(), total - next);
+			for (size_t ii = 0; ii < count; ++ii)
+			{
+				auto& slot = ring.write_slot(ii);
+				size_t value = next + ii;
+				memcpy(slot.data.data(), &value, sizeof(value));
+				slot.size = sizeof(value);
+			}
+			ring.publish(count);
+			next += count;
+			if (count == 0) std::this_thread::yield();
+		}
+	});
+
+	size_t expected = 0;
+	bool in_order = true;
+	while (expected < total)
+	{
+		auto ready = ring.ready();
+		for (size_t ii = 0; ii < ready; ++ii)
+		{
+			size_t value;
+			memcpy(&value, ring.read_slot(ii).data.data(), sizeof(value));
+			in_order = in_order && value == expected;
+			++expected;
+		}
+		ring.release(ready);
+		if (ready == 0) std::this_thread::yield();
+	}
+	producer.join();
+
+	BOOST_REQUIRE(in_order);
+	BOOST_REQUIRE_EQUAL(expected, total);
+	BOOST_REQUIRE_EQUAL(ring.ready(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+#include "mfextensions/Receivers/detail/PoolAllocator.hh"
+
+#define BOOST_TEST_MODULE PoolAllocator_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "PoolAllocator_t"
+#include "TRACE/tracemf.h"
+
+#include <cstdint>
+#include <list>
+#include <thread>
+#include <vector>
+
+using mfviewer::detail::pooled_string;
+using mfviewer::detail::PoolAllocator;
+using mfviewer::detail::SizeClassPools;
+using mfviewer::detail::SlabPool;
+
+BOOST_AUTO_TEST_SUITE(PoolAllocator_t)
+
+BOOST_AUTO_TEST_CASE(RecyclesBlocks)
+{
+	SlabPool pool(100, 1000);
+	BOOST_REQUIRE_EQUAL(pool.block_size() % alignof(std::max_align_t), 0);
+	BOOST_REQUIRE_GE(pool.block_size(), 100);
+
+	auto a = pool.allocate();
+	auto b = pool.allocate();
+	BOOST_REQUIRE_NE(a, b);
+	BOOST_REQUIRE_EQUAL(reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t), 0);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	BOOST_REQUIRE_EQUAL(pool.in_use(), 2);
+	auto capacity = pool.capacity();
+
+	pool.deallocate(a);
+	BOOST_REQUIRE_EQUAL(pool.allocate(), a);  // freed blocks are reused first
+
+	// Churn does not grow the pool
+	for (int round = 0; round < 100; ++round)
+	{
+		std::vector<void*> blocks;
+		for (size_t i = 0; i < capacity - 2; ++i) blocks.push_back(pool.allocate());
+		for (auto block : blocks) pool.deallocate(block);
+	}
+	BOOST_REQUIRE_EQUAL(pool.capacity(), capacity);
+	BOOST_REQUIRE_EQUAL(pool.in_use(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(Reserve)
+{
+	SlabPool pool(64, 64 * 16);
+	pool.reserve(100);
+	auto capacity = pool.capacity();
+	BOOST_REQUIRE_GE(capacity, 100);
+
+	std::vector<void*> blocks;
+	for (size_t i = 0; i < 100; ++i) blocks.push_back(pool.allocate());
+	BOOST_REQUIRE_EQUAL(pool.capacity(), capacity);
+	for (auto block : blocks) pool.deallocate(block);
+}
+
+BOOST_AUTO_TEST_CASE(Allocator)
+{
+	BOOST_REQUIRE(SizeClassPools::pool_for(1) != nullptr);
+	BOOST_REQUIRE(SizeClassPools::pool_for(SizeClassPools::max_size) != nullptr);
+	BOOST_REQUIRE(SizeClassPools::pool_for(SizeClassPools::max_size + 1) == nullptr);
+	BOOST_REQUIRE_GE(SizeClassPools::pool_for(200)->block_size(), 200);
+
+	auto value = std::allocate_shared<std::vector<int>>(PoolAllocator<std::vector<int>>(), 3, 7);
+	BOOST_REQUIRE_EQUAL(value->size(), 3);
+
+	pooled_string small("short");
+	pooled_string large(300, 'x');
+	pooled_string huge(10000, 'y');
+	large += small;
+	BOOST_REQUIRE_EQUAL(large.size(), 305);
+	BOOST_REQUIRE_EQUAL(huge.size(), 10000);
+
+	std::list<pooled_string, PoolAllocator<pooled_string>> strings(10, large);
+	BOOST_REQUIRE_EQUAL(strings.back(), large);
+}
+
+BOOST_AUTO_TEST_CASE(CrossThreadFree)
+{
+	const size_t total = 100000;
+	std::vector<std::shared_ptr<pooled_string>> made(total);
+
+	// Made on one thread and released on another, like messages going from a receiver to the viewer
+	std::thread producer([&] {
+		for (size_t i = 0; i < total; ++i)
+		{
+			made[i] = std::allocate_shared<pooled_string>(PoolAllocator<pooled_string>(), 20 + i % 500, 'm');
+		}
+	});
+	producer.join();
+	std::thread consumer([&] {
+		for (size_t i = 0; i < total; ++i)
+		{
+			BOOST_REQUIRE_EQUAL(made[i]->size(), 20 + i % 500);
+			made[i].reset();
+		}
+	});
+	consumer.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,157 @@
+#include "mfextensions/Receivers/detail/MessageRing.hh"
+#include "mfextensions/Receivers/detail/PositionBitmap.hh"
+
+#define BOOST_TEST_MODULE PositionBitmap_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "PositionBitmap_t"
+#include "TRACE/tracemf.h"
+
+#include <chrono>
+#include <random>
+#include <set>
+#include <vector>
+
+using mfviewer::detail::BitmapIndex;
+using mfviewer::detail::MessageRing;
+using mfviewer::detail::PositionBitmap;
+using mfviewer::detail::select_positions;
+
+namespace {
+struct Msg
+{
+	int host;
+	int cat;
+};
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(PositionBitmap_t)
+
+BOOST_AUTO_TEST_CASE(Containers)
+{
+	PositionBitmap sparse;
+	PositionBitmap dense;
+	for (PositionBitmap::position_t p = 10; p < 200000; p += 1000) sparse.add(p);
+	for (PositionBitmap::position_t p = 0; p < 200000; p += 3) dense.add(p);  // more than array_max per chunk
+
+	BOOST_REQUIRE(sparse.contains(1010));
+	BOOST_REQUIRE(!sparse.contains(1011));
+	BOOST_REQUIRE(dense.contains(65535 + 3));
+	BOOST_REQUIRE(!dense.contains(65535 + 2));
+
+	auto both = select_positions({{&sparse}, {&dense}}, 0, 200000);
+	std::vector<PositionBitmap::position_t> expected;
+	for (PositionBitmap::position_t p = 10; p < 200000; p += 1000)
+	{
+		if (p % 3 == 0) expected.push_back(p);
+	}
+	BOOST_REQUIRE(both == expected);
+
+	dense.drop_before(140000);
+	BOOST_REQUIRE(!dense.contains(0));
+	BOOST_REQUIRE(dense.contains(131073));  // same chunk as 140000
+	BOOST_REQUIRE(select_positions({{&dense}}, 140000, 140010) == std::vector<PositionBitmap::position_t>({140001, 140004, 140007}));
+	BOOST_REQUIRE(select_positions({{nullptr}}, 0, 1000).empty());
+}
+
+BOOST_AUTO_TEST_CASE(MatchesBruteForce)
+{
+	const size_t capacity = 70000;
+	const int nHosts = 40;
+	const int nCats = 7;
+	std::mt19937 gen(7);
+	std::uniform_int_distribution<int> host_dist(0, nHosts - 1);
+	std::uniform_int_distribution<int> cat_dist(0, nCats - 1);
+
+	MessageRing<Msg> ring(capacity);
+	BitmapIndex<int> hosts;
+	BitmapIndex<int> cats;
+	for (size_t i = 0; i < 250000; ++i)
+	{
+		Msg msg{host_dist(gen), i % 1000 < 10 ? 0 : cat_dist(gen)};  // a mix of sparse and dense chunks
+		auto position = ring.push_back(msg);
+		hosts.add(msg.host, position);
+		cats.add(msg.cat, position);
+		while (ring.size() > capacity)
+		{
+			hosts.evict(ring.front().host, ring.begin());
+			cats.evict(ring.front().cat, ring.begin());
+			ring.pop_front();
+		}
+	}
+
+	std::set<int> host_sel{1, 5, 17, 33};
+	std::set<int> cat_sel{0, 3};
+	std::vector<PositionBitmap const*> host_maps;
+	std::vector<PositionBitmap const*> cat_maps;
+	for (auto h : host_sel) host_maps.push_back(hosts.find(h));
+	for (auto c : cat_sel) cat_maps.push_back(cats.find(c));
+
+	auto selected = select_positions({host_maps, cat_maps}, ring.begin(), ring.end());
+	std::vector<PositionBitmap::position_t> expected;
+	for (auto p = ring.begin(); p != ring.end(); ++p)
+	{
+		if (host_sel.count(ring[p].host) && cat_sel.count(ring[p].cat)) expected.push_back(p);
+	}
+	BOOST_REQUIRE_EQUAL(selected.size(), expected.size());
+	BOOST_REQUIRE(selected == expected);
+
+	// A group with no bitmaps is ignored
+	BOOST_REQUIRE_EQUAL(select_positions({{}, {hosts.find(3)}}, ring.begin(), ring.end()).size(),
+	                    select_positions({{hosts.find(3)}}, ring.begin(), ring.end()).size());
+}
+
+BOOST_AUTO_TEST_CASE(EvictRemovesKeys)
+{
+	MessageRing<Msg> ring;
+	BitmapIndex<int> hosts;
+	for (int i = 0; i < 5; ++i) hosts.add(i % 2, ring.push_back(Msg{i % 2, 0}));
+	BOOST_REQUIRE_EQUAL(hosts.map().size(), 2);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		BOOST_REQUIRE(!hosts.evict(ring.front().host, ring.begin()));
+		ring.pop_front();
+	}
+	BOOST_REQUIRE(hosts.evict(ring.front().host, ring.begin()));  // the last host 1
+	ring.pop_front();
+	BOOST_REQUIRE(hosts.find(1) == nullptr);
+	BOOST_REQUIRE(!hosts.evict(9, 0));  // unknown keys are not added
+	BOOST_REQUIRE_EQUAL(hosts.map().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(FilterCost)
+{
+	// A full 100k-message pool, filtered on hundreds of hosts and a category
+	const size_t capacity = 100000;
+	const int nHosts = 500;
+	MessageRing<Msg> ring(capacity);
+	BitmapIndex<int> hosts;
+	BitmapIndex<int> cats;
+	for (size_t i = 0; i < capacity; ++i)
+	{
+		Msg msg{static_cast<int>(i * 7919 % nHosts), static_cast<int>(i / 7 % 40)};
+		auto position = ring.push_back(msg);
+		hosts.add(msg.host, position);
+		cats.add(msg.cat, position);
+	}
+
+	std::vector<PositionBitmap const*> host_maps;
+	for (int h = 0; h < nHosts; h += 2) host_maps.push_back(hosts.find(h));
+
+	auto start = std::chrono::steady_clock::now();
+	auto selected = select_positions({host_maps, {cats.find(3)}}, ring.begin(), ring.end());
+	auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	TLOG(TLVL_INFO) << "Selected " << selected.size() << " of " << capacity << " messages on " << host_maps.size()
+	                << " hosts and 1 category in " << elapsed << " ms";
+
+	size_t expected = 0;
+	for (auto p = ring.begin(); p != ring.end(); ++p)
+	{
+		if (ring[p].host % 2 == 0 && ring[p].cat == 3) ++expected;
+	}
+	BOOST_REQUIRE_EQUAL(selected.size(), expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+#include "mfextensions/Receivers/detail/SPSCQueue.hh"
+
+#define BOOST_TEST_MODULE SPSCQueue_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "SPSCQueue_t"
+#include "TRACE/tracemf.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using mfviewer::detail::SPSCQueue;
+
+BOOST_AUTO_TEST_SUITE(SPSCQueue_t)
+
+BOOST_AUTO_TEST_CASE(SingleThread)
+{
+	SPSCQueue<std::vector<int>> queue(2);
+	BOOST_REQUIRE_EQUAL(queue.capacity(), 2);
+
+	std::vector<int> value{1, 2, 3};
+	BOOST_REQUIRE(queue.try_push(value));
+	BOOST_REQUIRE(value.empty());  // moved from
+	value = {4};
+	BOOST_REQUIRE(queue.try_push(value));
+	value = {5};
+	BOOST_REQUIRE(!queue.try_push(value));
+	BOOST_REQUIRE_EQUAL(value.size(), 1);  // left alone when full
+	BOOST_REQUIRE_EQUAL(queue.size(), 2);
+
+	std::vector<int> out;
+	BOOST_REQUIRE(queue.try_pop(out));
+	BOOST_REQUIRE_EQUAL(out.size(), 3);
+	BOOST_REQUIRE(queue.try_push(value));  // wraps around
+	BOOST_REQUIRE(queue.try_pop(out));
+	BOOST_REQUIRE_EQUAL(out[0], 4);
+	BOOST_REQUIRE(queue.try_pop(out));
+	BOOST_REQUIRE_EQUAL(out[0], 5);
+	BOOST_REQUIRE(!queue.try_pop(out));
+	BOOST_REQUIRE_EQUAL(queue.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ReleasesPoppedValues)
+{
+	SPSCQueue<std::shared_ptr<int>> queue(4);
+	auto value = std::make_shared<int>(42);
+	std::weak_ptr<int> watch = value;
+
+	BOOST_REQUIRE(queue.try_push(value));
+	std::shared_ptr<int> out;
+	BOOST_REQUIRE(queue.try_pop(out));
+	out.reset();
+	BOOST_REQUIRE(watch.expired());
+}
+
+BOOST_AUTO_TEST_CASE(ProducerConsumer)
+{
+	const size_t total = 200000;
+	SPSCQueue<size_t> queue(64);
+
+	std::thread producer([&] {
+		for (size_t next = 0; next < total;)
+		{
+			size_t value = next;
+			if (queue.try_push(value))
+				++next;
+			else
+				std::this_thread::yield();
+		}
+	});
+
+	size_t expected = 0;
+	bool in_order = true;
+	while (expected < total)
+	{
+		size_t value;
+		if (!queue.try_pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		if (value != expected) in_order = false;
+		++expected;
+	}
+	producer.join();
+
+	BOOST_REQUIRE(in_order);
+	BOOST_REQUIRE_EQUAL(queue.size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
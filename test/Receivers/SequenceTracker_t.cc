@@ -0,0 +1,89 @@
+#include "mfextensions/Receivers/detail/SequenceTracker.hh"
+
+#define BOOST_TEST_MODULE SequenceTracker_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "SequenceTracker_t"
+#include "TRACE/tracemf.h"
+
+using mfviewer::detail::SequenceTracker;
+
+BOOST_AUTO_TEST_SUITE(SequenceTracker_t)
+
+BOOST_AUTO_TEST_CASE(InOrder)
+{
+	SequenceTracker tracker;
+	for (int seq = 1; seq <= 100; ++seq) tracker.record("daq01", 100, seq);
+	for (int seq = 1; seq <= 50; ++seq) tracker.record("daq01", 200, seq);
+	for (int seq = 1; seq <= 50; ++seq) tracker.record("daq02", 100, seq);
+
+	auto const& stats = tracker.stats();
+	BOOST_REQUIRE_EQUAL(stats.received, 200);
+	BOOST_REQUIRE_EQUAL(stats.senders, 3);
+	BOOST_REQUIRE_EQUAL(stats.missing, 0);
+	BOOST_REQUIRE_EQUAL(stats.duplicates, 0);
+	BOOST_REQUIRE_EQUAL(stats.reordered, 0);
+	BOOST_REQUIRE_EQUAL(stats.resets, 0);
+}
+
+BOOST_AUTO_TEST_CASE(GapsDuplicatesReorders)
+{
+	SequenceTracker tracker;
+	for (int seq : {1, 2, 5, 6, 3, 6, 10})
+	{
+		tracker.record("daq01", 100, seq);
+	}
+
+	auto const& stats = tracker.stats();
+	BOOST_REQUIRE_EQUAL(stats.received, 7);
+	BOOST_REQUIRE_EQUAL(stats.reordered, 1);   // 3 arrived after 5
+	BOOST_REQUIRE_EQUAL(stats.duplicates, 1);  // 6 twice
+	BOOST_REQUIRE_EQUAL(stats.missing, 4);     // 4, 7, 8 and 9
+	BOOST_REQUIRE_EQUAL(stats.resets, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SenderRestart)
+{
+	SequenceTracker tracker;
+	for (int seq = 1; seq <= 2 * SequenceTracker::WINDOW; ++seq) tracker.record("daq01", 100, seq);
+	tracker.record("daq01", 100, 1);
+	tracker.record("daq01", 100, 2);
+
+	auto const& stats = tracker.stats();
+	BOOST_REQUIRE_EQUAL(stats.resets, 1);
+	BOOST_REQUIRE_EQUAL(stats.missing, 0);
+	BOOST_REQUIRE_EQUAL(stats.duplicates, 0);
+	BOOST_REQUIRE_EQUAL(stats.reordered, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SenderRestartInsideWindow)
+{
+	SequenceTracker tracker;
+	for (int seq = 1; seq <= 100; ++seq) tracker.record("daq01", 100, seq);
+	for (int seq = 1; seq <= 50; ++seq) tracker.record("daq01", 100, seq);
+	tracker.record("daq01", 100, 50);  // a real duplicate, right behind the original
+
+	auto const& stats = tracker.stats();
+	BOOST_REQUIRE_EQUAL(stats.resets, 1);
+	BOOST_REQUIRE_EQUAL(stats.missing, 0);
+	BOOST_REQUIRE_EQUAL(stats.duplicates, 1);
+	BOOST_REQUIRE_EQUAL(stats.reordered, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Sessions)
+{
+	// A sender which carries its session is tracked afresh when the session changes
+	SequenceTracker tracker;
+	for (int seq = 1; seq <= 100; ++seq) tracker.record("daq01", 100, seq, 0x1111);
+	for (int seq = 1; seq <= 100; ++seq) tracker.record("daq01", 100, seq, 0x2222);
+
+	auto const& stats = tracker.stats();
+	BOOST_REQUIRE_EQUAL(stats.senders, 2);
+	BOOST_REQUIRE_EQUAL(stats.resets, 0);
+	BOOST_REQUIRE_EQUAL(stats.missing, 0);
+	BOOST_REQUIRE_EQUAL(stats.duplicates, 0);
+	BOOST_REQUIRE_EQUAL(stats.reordered, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
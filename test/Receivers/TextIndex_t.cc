@@ -0,0 +1,133 @@
+#include "mfextensions/Receivers/detail/MessageRing.hh"
+#include "mfextensions/Receivers/detail/TextIndex.hh"
+
+#define BOOST_TEST_MODULE TextIndex_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "TextIndex_t"
+#include "TRACE/tracemf.h"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+using mfviewer::detail::MessageRing;
+using mfviewer::detail::TextIndex;
+
+namespace {
+typedef std::vector<TextIndex::position_t> positions_t;
+
+// Every position in the ring whose text contains the query, found the slow way
+positions_t brute_force(MessageRing<std::string> const& ring, std::string const& query)
+{
+	positions_t matches;
+	for (auto p = ring.begin(); p != ring.end(); ++p)
+	{
+		if (TextIndex::contains(ring[p], query)) matches.push_back(p);
+	}
+	return matches;
+}
+
+std::string make_body(std::mt19937& gen)
+{
+	static const char* const words[] = {"Run", "subrun", "event", "fragment", "timeout", "Error", "code", "board", "ok", "retry"};
+	std::uniform_int_distribution<int> word(0, 9);
+	std::uniform_int_distribution<int> number(0, 99999);
+	std::string body;
+	for (int i = 0; i < 6; ++i)
+	{
+		body += words[word(gen)];  // NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+		body += ' ';
+		body += std::to_string(number(gen));
+		body += ' ';
+	}
+	return body;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(TextIndex_t)
+
+BOOST_AUTO_TEST_CASE(Search)
+{
+	MessageRing<std::string> ring;
+	TextIndex index;
+	for (std::string body : {"Run 1234 started", "run 1235 started", "Error code 0x1F on board 7", "ok", "RUN 12345 stopped"})
+	{
+		index.add(body, ring.push_back(body));
+	}
+	auto text_at = [&](TextIndex::position_t p) { return std::string_view(ring[p]); };
+
+	BOOST_REQUIRE(index.search("run 1234", ring.begin(), ring.end(), text_at) == positions_t({0, 4}));
+	BOOST_REQUIRE(index.search("0X1f", ring.begin(), ring.end(), text_at) == positions_t({2}));
+	BOOST_REQUIRE(index.search("ok", ring.begin(), ring.end(), text_at) == positions_t({3}));  // shorter than a trigram
+	BOOST_REQUIRE(index.search("started ", ring.begin(), ring.end(), text_at).empty());
+	BOOST_REQUIRE(index.search("zzz", ring.begin(), ring.end(), text_at).empty());
+
+	// Evicted messages are forgotten
+	index.evict(ring.front(), ring.begin());
+	ring.pop_front();
+	BOOST_REQUIRE(index.search("run 1234", ring.begin(), ring.end(), text_at) == positions_t({4}));
+	while (!ring.empty())
+	{
+		index.evict(ring.front(), ring.begin());
+		ring.pop_front();
+	}
+	BOOST_REQUIRE_EQUAL(index.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MatchesBruteForce)
+{
+	const size_t capacity = 20000;
+	std::mt19937 gen(22);
+	MessageRing<std::string> ring(capacity);
+	TextIndex index;
+	for (size_t i = 0; i < 3 * capacity; ++i)
+	{
+		auto body = make_body(gen);
+		index.add(body, ring.push_back(body));
+		if (ring.size() > capacity)
+		{
+			index.evict(ring.front(), ring.begin());
+			ring.pop_front();
+		}
+	}
+
+	auto text_at = [&](TextIndex::position_t p) { return std::string_view(ring[p]); };
+	for (std::string query : {"run 4", "ERROR 12", "timeout 9999", "d 1", "7 ", "fragment 31415", "board"})
+	{
+		BOOST_REQUIRE(index.search(query, ring.begin(), ring.end(), text_at) == brute_force(ring, query));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(SearchCost)
+{
+	// Looking up a run number in a full 100k-message pool
+	const size_t capacity = 100000;
+	std::mt19937 gen(5);
+	MessageRing<std::string> ring(capacity);
+	TextIndex index;
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < capacity; ++i)
+	{
+		auto body = make_body(gen);
+		index.add(body, ring.push_back(body));
+	}
+	auto indexed = std::chrono::steady_clock::now();
+
+	auto text_at = [&](TextIndex::position_t p) { return std::string_view(ring[p]); };
+	auto matches = index.search("run 314", ring.begin(), ring.end(), text_at);
+	auto searched = std::chrono::steady_clock::now();
+	auto expected = brute_force(ring, "run 314");
+	auto scanned = std::chrono::steady_clock::now();
+
+	TLOG(TLVL_INFO) << "Indexed " << capacity << " messages (" << index.size() << " trigrams) in "
+	                << std::chrono::duration<double, std::milli>(indexed - start).count() << " ms; found " << matches.size()
+	                << " in " << std::chrono::duration<double, std::milli>(searched - indexed).count() << " ms against "
+	                << std::chrono::duration<double, std::milli>(scanned - searched).count() << " ms for a scan";
+	BOOST_REQUIRE(matches == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+#include "mfextensions/Receivers/detail/TimestampDecoder.hh"
+
+#define BOOST_TEST_MODULE TimestampDecoder_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "TimestampDecoder_t"
+#include "TRACE/tracemf.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+using mfviewer::detail::TimestampDecoder;
+
+namespace {
+// The conversion done by the receivers before they used TimestampDecoder
+time_t legacy_decode(std::string const& text)
+{
+	struct tm tm = {};
+	if (strptime(text.c_str(), "%d-%b-%Y %H:%M:%S", &tm) == nullptr) return -1;
+	tm.tm_isdst = -1;
+	return mktime(&tm);
+}
+
+std::string format(time_t t)
+{
+	char buf[64];
+	struct tm tm;
+	strftime(buf, sizeof(buf), "%d-%b-%Y %H:%M:%S %Z", localtime_r(&t, &tm));
+	return buf;
+}
+
+// A zone with daylight saving changes, so that the per-day cache is exercised across them
+struct SetTimeZone
+{
+	SetTimeZone()
+	{
+		setenv("TZ", "America/Chicago", 1);
+		tzset();
+	}
+};
+}  // namespace
+
+BOOST_GLOBAL_FIXTURE(SetTimeZone);
+
+BOOST_AUTO_TEST_SUITE(TimestampDecoder_t)
+
+BOOST_AUTO_TEST_CASE(MatchesMktime)
+{
+	TimestampDecoder decoder;
+
+	// Every 7 minutes over a year, covering both daylight saving changes
+	time_t start = legacy_decode("01-Jan-2026 00:00:00");
+	for (time_t t = start; t < start + 366 * 86400; t += 7 * 60 + 13)
+	{
+		auto text = format(t);
+		timeval tv = {0, 0};
+		BOOST_REQUIRE(decoder.decode(text, tv));
+		BOOST_REQUIRE_EQUAL(tv.tv_sec, legacy_decode(text));
+		BOOST_REQUIRE_EQUAL(tv.tv_usec, 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(DaylightSavingDay)
+{
+	TimestampDecoder decoder;
+	timeval tv = {0, 0};
+
+	// Clocks go forward at 02:00 on 08-Mar-2026 in Chicago
+	for (auto text : {"08-Mar-2026 00:30:00", "08-Mar-2026 01:59:59", "08-Mar-2026 03:00:00", "08-Mar-2026 23:59:59"})
+	{
+		BOOST_REQUIRE(decoder.decode(text, tv));
+		BOOST_REQUIRE_EQUAL(tv.tv_sec, legacy_decode(text));
+	}
+	// And back at 02:00 on 01-Nov-2026
+	for (auto text : {"01-Nov-2026 00:30:00", "01-Nov-2026 03:00:00", "01-Nov-2026 12:34:56", "01-Nov-2026 23:59:59"})
+	{
+		BOOST_REQUIRE(decoder.decode(text, tv));
+		BOOST_REQUIRE_EQUAL(tv.tv_sec, legacy_decode(text));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(Fields)
+{
+	TimestampDecoder decoder;
+	timeval tv = {0, 0};
+	auto base = legacy_decode("17-Oct-2026 10:11:12");
+
+	BOOST_REQUIRE(decoder.decode("17-Oct-2026 10:11:12.345 CDT", tv));
+	BOOST_REQUIRE_EQUAL(tv.tv_sec, base);
+	BOOST_REQUIRE_EQUAL(tv.tv_usec, 345000);
+
+	BOOST_REQUIRE(decoder.decode("17-Oct-2026 10:11:12.123456789", tv));
+	BOOST_REQUIRE_EQUAL(tv.tv_usec, 123456);
+
+	BOOST_REQUIRE(decoder.decode("17-october-2026  10:11:12", tv));
+	BOOST_REQUIRE_EQUAL(tv.tv_sec, base);
+	BOOST_REQUIRE_EQUAL(tv.tv_usec, 0);
+
+	BOOST_REQUIRE(decoder.decode("7-OCT-2026 1:2:3", tv));
+	BOOST_REQUIRE_EQUAL(tv.tv_sec, legacy_decode("7-Oct-2026 1:2:3"));
+
+	for (auto text : {"", "17", "17-Oct", "17-Okt-2026 10:11:12", "32-Oct-2026 10:11:12", "17-Oct-2026 24:11:12",
+	                  "17-Oct-2026 10:60:12", "17-Oct-2026 10:11", "x17-Oct-2026 10:11:12"})
+	{
+		BOOST_REQUIRE(!decoder.decode(text, tv));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(Find)
+{
+	TimestampDecoder decoder;
+	timeval tv = {0, 0};
+
+	BOOST_REQUIRE(decoder.find("<13>117-Oct-2026 10:11:12", tv));
+	BOOST_REQUIRE_EQUAL(tv.tv_sec, legacy_decode("17-Oct-2026 10:11:12"));
+	BOOST_REQUIRE(!decoder.find("UDPMFMESSAGE4242", tv));
+	BOOST_REQUIRE(!decoder.find("no digits", tv));
+}
+
+BOOST_AUTO_TEST_CASE(DecodeBenchmark)
+{
+	const int iterations = 200000;
+	std::string const text = "17-Oct-2026 10:11:12 CDT";
+
+	auto start = std::chrono::steady_clock::now();
+	time_t check = 0;
+	for (int ii = 0; ii < iterations; ++ii) check += legacy_decode(text);
+	auto legacy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+	TimestampDecoder decoder;
+	timeval tv = {0, 0};
+	start = std::chrono::steady_clock::now();
+	for (int ii = 0; ii < iterations; ++ii)
+	{
+		decoder.decode(text, tv);
+		check -= tv.tv_sec;
+	}
+	auto new_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+	TLOG(TLVL_INFO) << "Timestamp decode: strptime+mktime " << legacy_ns << " ns; TimestampDecoder " << new_ns << " ns";
+	BOOST_REQUIRE_EQUAL(check, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,252 @@
+#include "mfextensions/Receivers/detail/UDPTextParser.hh"
+
+#define BOOST_TEST_MODULE UDPTextParser_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "UDPTextParser_t"
+#include "TRACE/tracemf.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <list>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Count every heap allocation made by this test, so the benchmark can report allocations per message
+static std::atomic<size_t> allocations{0};
+
+// Not inlined, so that the compiler does not pair these with its built-in knowledge of malloc/free
+__attribute__((noinline)) void* operator new(size_t size)
+{
+	++allocations;
+	void* ptr = std::malloc(size == 0 ? 1 : size);  // NOLINT(cppcoreguidelines-no-malloc)
+	if (ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+}
+__attribute__((noinline)) void operator delete(void* ptr) noexcept { std::free(ptr); }                   // NOLINT(cppcoreguidelines-no-malloc)
+__attribute__((noinline)) void operator delete(void* ptr, size_t /*size*/) noexcept { std::free(ptr); }  // NOLINT(cppcoreguidelines-no-malloc)
+
+using mfviewer::detail::TextMessageFields;
+using mfviewer::detail::TimestampDecoder;
+using mfviewer::detail::UDPTextParser;
+
+namespace {
+// Datagrams as written by ELUDP's text format, from a DAQ test stand
+std::vector<std::string> const corpus{
+    "UDPMFMESSAGE28741|17-Oct-2026 10:11:12 UTC|1|daq01.fnal.gov|131.225.0.1|INFO|BoardReaderCore|boardreader01|28741|"
+    "Run 1021, Subrun 1, Event 17|BoardReaderCore|BoardReaderCore.cc|412|Fragment rate: 99.8 Hz",
+    "UDPMFMESSAGE28741|17-Oct-2026 10:11:12 UTC|2|daq01.fnal.gov|131.225.0.1|WARNING|DataSenderManager|boardreader01|28741|"
+    "Run 1021, Subrun 1, Event 18|BoardReaderCore|DataSenderManager.cc|233|Send of fragment 18 to rank 4 timed out after 1000000 us",
+    "UDPMFMESSAGE30112|17-Oct-2026 10:11:13 UTC|57|daq02.fnal.gov|131.225.0.2|DEBUG|EventBuilder!eb01|eventbuilder01|30112|"
+    "Run 1021, Subrun 1, Event 19|EventBuilder|SharedMemoryEventManager.cc|1088|Buffer 12 state: WRITING | READY | FULL",
+    "UDPMFMESSAGE30112|17-Oct-2026 10:11:14 UTC|58|daq02.fnal.gov|131.225.0.2|ERROR|RootOutput|eventbuilder01|30112|"
+    "Run 1021, Subrun 1, Event 19|RootOutput|RootOutput_module.cc|97|Unable to open file /data/run1021/"
+    "run1021_subrun1.root: No space left on device\\nWill retry in 5 seconds",
+    "UDPMFMESSAGE4242|17-Oct-2026 10:11:15 UTC|1204|dispatcher.fnal.gov|131.225.0.9|INFO|Dispatcher|dispatcher|4242|"
+    "BeginRun|Dispatcher||0|",
+};
+
+// The parsing done by UDPReceiver::read_msg before it used UDPTextParser, kept as the benchmark baseline
+std::list<std::string> legacy_tokenize(std::string const& input)
+{
+	size_t pos = 0;
+	std::list<std::string> output;
+
+	while (pos != std::string::npos && pos < input.size())
+	{
+		auto newpos = input.find('|', pos);
+		if (newpos != std::string::npos)
+		{
+			output.emplace_back(input, pos, newpos - pos);
+			pos = newpos + 1;
+		}
+		else
+		{
+			output.emplace_back(input, pos);
+			pos = newpos;
+		}
+	}
+	return output;
+}
+
+size_t legacy_parse(std::string const& input)
+{
+	std::string hostname, category, application, message, hostaddr, file, line, module, eventID, severity;
+	int pid = 0;
+	int seqNum = 0;
+
+	auto tokens = legacy_tokenize(input);
+	auto it = tokens.begin();
+
+	bool timestamp_found = false;
+	struct tm tm;
+	while (it != tokens.end() && !timestamp_found)
+	{
+		std::string thisString = *it;
+		while (!thisString.empty() && !timestamp_found)
+		{
+			auto pos = thisString.find_first_of("0123456789");
+			if (pos == std::string::npos) break;
+			thisString = thisString.erase(0, pos);
+			if (strptime(thisString.c_str(), "%d-%b-%Y %H:%M:%S", &tm) != nullptr)
+			{
+				timestamp_found = true;
+				break;
+			}
+			if (!thisString.empty()) thisString = thisString.erase(0, 1);
+		}
+		++it;
+	}
+
+	auto prevIt = it;
+	try
+	{
+		if (it != tokens.end() && ++it != tokens.end()) seqNum = std::stoi(*it);
+	}
+	catch (const std::invalid_argument& e)
+	{
+		it = prevIt;
+	}
+	if (it != tokens.end() && ++it != tokens.end()) hostname = *it;
+	if (it != tokens.end() && ++it != tokens.end()) hostaddr = *it;
+	if (it != tokens.end() && ++it != tokens.end()) severity = *it;
+	if (it != tokens.end() && ++it != tokens.end()) category = *it;
+	if (it != tokens.end() && ++it != tokens.end()) application = *it;
+	prevIt = it;
+	try
+	{
+		if (it != tokens.end() && ++it != tokens.end()) pid = std::stol(*it);
+	}
+	catch (const std::invalid_argument& e)
+	{
+		it = prevIt;
+	}
+	if (it != tokens.end() && ++it != tokens.end()) eventID = *it;
+	if (it != tokens.end() && ++it != tokens.end()) module = *it;
+	if (it != tokens.end() && ++it != tokens.end()) file = *it;
+	if (it != tokens.end() && ++it != tokens.end()) line = *it;
+	std::ostringstream oss;
+	bool first = true;
+	while (it != tokens.end() && ++it != tokens.end())
+	{
+		if (!first) oss << "|";
+		first = false;
+		oss << *it;
+	}
+	message = oss.str();
+
+	return hostname.size() + message.size() + static_cast<size_t>(pid + seqNum);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(UDPTextParser_t)
+
+BOOST_AUTO_TEST_CASE(ParseFields)
+{
+	TimestampDecoder timestamps;
+	TextMessageFields fields;
+	UDPTextParser::parse(corpus[2], timestamps, fields);
+
+	BOOST_REQUIRE(fields.has_timestamp);
+	struct tm tm = {};
+	strptime("17-Oct-2026 10:11:13", "%d-%b-%Y %H:%M:%S", &tm);
+	tm.tm_isdst = -1;
+	BOOST_REQUIRE_EQUAL(fields.time.tv_sec, mktime(&tm));
+	BOOST_REQUIRE_EQUAL(fields.seqNum, 57);
+	BOOST_REQUIRE_EQUAL(fields.pid, 30112);
+	BOOST_REQUIRE(fields.hostname == "daq02.fnal.gov");
+	BOOST_REQUIRE(fields.hostaddr == "131.225.0.2");
+	BOOST_REQUIRE(fields.severity == "DEBUG");
+	BOOST_REQUIRE(fields.category == "EventBuilder!eb01");
+	BOOST_REQUIRE(fields.application == "eventbuilder01");
+	BOOST_REQUIRE(fields.iteration == "Run 1021, Subrun 1, Event 19");
+	BOOST_REQUIRE(fields.module == "EventBuilder");
+	BOOST_REQUIRE(fields.file == "SharedMemoryEventManager.cc");
+	BOOST_REQUIRE(fields.line == "1088");
+	BOOST_REQUIRE(fields.body == "Buffer 12 state: WRITING | READY | FULL");
+
+	UDPTextParser::parse(corpus[4], timestamps, fields);
+	BOOST_REQUIRE_EQUAL(fields.seqNum, 1204);
+	BOOST_REQUIRE(fields.file.empty());
+	BOOST_REQUIRE(fields.line == "0");
+	BOOST_REQUIRE(fields.body.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MissingNumbers)
+{
+	// A sender which omits the sequence number and PID
+	TimestampDecoder timestamps;
+	TextMessageFields fields;
+	UDPTextParser::parse("<13>MF|17-Oct-2026 10:11:12|host|addr|INFO|cat|app|iter|mod|file.cc|7|body|more|", timestamps, fields);
+
+	BOOST_REQUIRE(fields.has_timestamp);
+	BOOST_REQUIRE_EQUAL(fields.seqNum, 0);
+	BOOST_REQUIRE_EQUAL(fields.pid, 0);
+	BOOST_REQUIRE(fields.hostname == "host");
+	BOOST_REQUIRE(fields.application == "app");
+	BOOST_REQUIRE(fields.iteration == "iter");
+	BOOST_REQUIRE(fields.line == "7");
+	BOOST_REQUIRE(fields.body == "body|more");
+}
+
+BOOST_AUTO_TEST_CASE(Truncated)
+{
+	TimestampDecoder timestamps;
+	TextMessageFields fields;
+	UDPTextParser::parse("UDPMFMESSAGE1|17-Oct-2026 10:11:12 UTC|5|host", timestamps, fields);
+	BOOST_REQUIRE(fields.has_timestamp);
+	BOOST_REQUIRE_EQUAL(fields.seqNum, 5);
+	BOOST_REQUIRE(fields.hostname == "host");
+	BOOST_REQUIRE(fields.hostaddr.empty());
+	BOOST_REQUIRE(fields.body.empty());
+
+	// No timestamp anywhere, including tokens without digits
+	UDPTextParser::parse("MF|no|time|here", timestamps, fields);
+	BOOST_REQUIRE(!fields.has_timestamp);
+	BOOST_REQUIRE(fields.hostname.empty());
+
+	UDPTextParser::parse("", timestamps, fields);
+	BOOST_REQUIRE(!fields.has_timestamp);
+}
+
+BOOST_AUTO_TEST_CASE(ParseBenchmark)
+{
+	const int iterations = 20000;
+
+	auto start = std::chrono::steady_clock::now();
+	size_t before = allocations;
+	size_t check = 0;
+	for (int ii = 0; ii < iterations; ++ii)
+	{
+		for (auto const& packet : corpus) check += legacy_parse(packet);
+	}
+	double legacy_allocs = static_cast<double>(allocations - before) / (iterations * corpus.size());
+	auto legacy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / (iterations * corpus.size());
+
+	TimestampDecoder timestamps;
+	TextMessageFields fields;
+	start = std::chrono::steady_clock::now();
+	before = allocations;
+	for (int ii = 0; ii < iterations; ++ii)
+	{
+		for (auto const& packet : corpus)
+		{
+			UDPTextParser::parse(packet, timestamps, fields);
+			check += fields.hostname.size() + fields.body.size();
+		}
+	}
+	double new_allocs = static_cast<double>(allocations - before) / (iterations * corpus.size());
+	auto new_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / (iterations * corpus.size());
+
+	TLOG(TLVL_INFO) << "Text parse, per message: legacy " << legacy_allocs << " allocations, " << legacy_ns
+	                << " ns; UDPTextParser " << new_allocs << " allocations, " << new_ns << " ns (" << check << ")";
+
+	BOOST_REQUIRE_EQUAL(new_allocs, 0.0);
+	BOOST_REQUIRE_GT(legacy_allocs, 10.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
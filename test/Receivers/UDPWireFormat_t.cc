@@ -0,0 +1,266 @@
+#include "mfextensions/Receivers/detail/UDPWireFormat.hh"
+
+#define BOOST_TEST_MODULE UDPWireFormat_t
+#include "cetlib/quiet_unit_test.hpp"
+#include "cetlib_except/exception.h"
+
+#define TRACE_NAME "UDPWireFormat_t"
+#include "TRACE/tracemf.h"
+
+#include <map>
+#include <vector>
+
+using namespace mfviewer::detail;
+
+BOOST_AUTO_TEST_SUITE(UDPWireFormat_t)
+
+BOOST_AUTO_TEST_CASE(FramedRoundTrip)
+{
+	std::vector<std::string> records{"UDPMFMESSAGE1|first", "UDPMFMESSAGE1|second", ""};
+
+	std::string frame;
+	begin_frame(frame);
+	BOOST_REQUIRE(is_framed(frame.data(), frame.size()));
+	BOOST_REQUIRE_EQUAL(frame_record_count(frame), 0);
+
+	for (auto const& record : records)
+	{
+		BOOST_REQUIRE(append_record(frame, record.data(), record.size(), 1472));
+	}
+	BOOST_REQUIRE_EQUAL(frame_record_count(frame), records.size());
+
+	std::vector<std::string> unpacked;
+	BOOST_REQUIRE(unpack_frame(frame.data(), frame.size(), [&](char const* data, size_t len) { unpacked.emplace_back(data, len); }));
+	BOOST_REQUIRE(unpacked == records);
+}
+
+BOOST_AUTO_TEST_CASE(FramedSizeLimit)
+{
+	std::string record(100, 'x');
+	std::string frame;
+	begin_frame(frame);
+
+	size_t count = 0;
+	while (append_record(frame, record.data(), record.size(), 1000)) ++count;
+	BOOST_REQUIRE_EQUAL(count, (1000 - FRAMED_HEADER_SIZE) / (record.size() + FRAMED_RECORD_HEADER_SIZE));
+	BOOST_REQUIRE_LE(frame.size(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(PlainAndTruncated)
+{
+	std::string plain = "UDPMFMESSAGE1234|01-Jan-2024 00:00:00|1|host";
+	BOOST_REQUIRE(!is_framed(plain.data(), plain.size()));
+	BOOST_REQUIRE(!unpack_frame(plain.data(), plain.size(), [](char const*, size_t) {}));
+
+	std::string record = "UDPMFMESSAGE1|body";
+	std::string frame;
+	begin_frame(frame);
+	append_record(frame, record.data(), record.size(), 1472);
+	append_record(frame, record.data(), record.size(), 1472);
+
+	size_t delivered = 0;
+	BOOST_REQUIRE(!unpack_frame(frame.data(), frame.size() - 1, [&](char const*, size_t) { ++delivered; }));
+	BOOST_REQUIRE_EQUAL(delivered, 1);
+}
+
+BOOST_AUTO_TEST_CASE(BinaryRoundTrip)
+{
+	std::string body = "Message body | with a pipe\nand a newline";
+	BinaryRecord in;
+	in.severity = 4;
+	in.timestamp_us = 1700000000123456ULL;
+	in.seqNum = 42;
+	in.pid = 12345;
+	in.line = 99;
+	in.hostname = "daq01.fnal.gov";
+	in.hostaddr = "131.225.0.1";
+	in.category = "EventBuilder";
+	in.application = "boardreader";
+	in.iteration = "Run 1, Event 2";
+	in.module = "";
+	in.file = "artdaq/DAQrate/DataSenderManager.cc";
+	in.message = body;
+
+	std::string payload;
+	append_binary_record(payload, in);
+	BOOST_REQUIRE(is_binary_record(payload.data(), payload.size()));
+	BOOST_REQUIRE(!is_framed(payload.data(), payload.size()));
+
+	BinaryRecord out;
+	BOOST_REQUIRE(decode_binary_record(payload.data(), payload.size(), out));
+	BOOST_REQUIRE_EQUAL(out.severity, in.severity);
+	BOOST_REQUIRE_EQUAL(out.timestamp_us, in.timestamp_us);
+	BOOST_REQUIRE_EQUAL(out.seqNum, in.seqNum);
+	BOOST_REQUIRE_EQUAL(out.pid, in.pid);
+	BOOST_REQUIRE_EQUAL(out.line, in.line);
+	BOOST_REQUIRE(out.hostname == in.hostname);
+	BOOST_REQUIRE(out.hostaddr == in.hostaddr);
+	BOOST_REQUIRE(out.category == in.category);
+	BOOST_REQUIRE(out.application == in.application);
+	BOOST_REQUIRE(out.iteration == in.iteration);
+	BOOST_REQUIRE(out.module.empty());
+	BOOST_REQUIRE(out.file == in.file);
+	BOOST_REQUIRE(out.message == in.message);
+
+	// Every truncation must be rejected
+	for (size_t len = 0; len < payload.size(); ++len)
+	{
+		BOOST_REQUIRE(!decode_binary_record(payload.data(), len, out));
+	}
+
+	// Binary records can be packed into frames like text ones
+	std::string frame;
+	begin_frame(frame);
+	BOOST_REQUIRE(append_record(frame, payload.data(), payload.size(), MAX_UDP_PAYLOAD));
+	size_t decoded = 0;
+	BOOST_REQUIRE(unpack_frame(frame.data(), frame.size(), [&](char const* data, size_t len) {
+		BinaryRecord rec;
+		if (decode_binary_record(data, len, rec) && rec.message == body) ++decoded;
+	}));
+	BOOST_REQUIRE_EQUAL(decoded, 1);
+}
+
+BOOST_AUTO_TEST_CASE(BinarySeverityRange)
+{
+	BinaryRecord in;
+	in.severity = MAX_SEVERITY;
+	in.message = "severe";
+	std::string payload;
+	append_binary_record(payload, in);
+
+	BinaryRecord out;
+	BOOST_REQUIRE(decode_binary_record(payload.data(), payload.size(), out));
+	BOOST_REQUIRE_EQUAL(out.severity, MAX_SEVERITY);
+
+	// A severity byte past the last mf::ELseverityLevel must not reach the receiver's enum cast
+	for (int severity : {MAX_SEVERITY + 1, 0xFF})
+	{
+		payload[BINARY_MAGIC_SIZE + 1] = static_cast<char>(severity);
+		BOOST_REQUIRE(!decode_binary_record(payload.data(), payload.size(), out));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(DictionaryRoundTrip)
+{
+	std::string dict;
+	begin_dictionary(dict, 0x0123456789abcdefULL, 4242);
+	BOOST_REQUIRE(is_dictionary(dict.data(), dict.size()));
+	BOOST_REQUIRE(!is_binary_record(dict.data(), dict.size()));
+	BOOST_REQUIRE(append_dictionary_entry(dict, 0, "daq01.fnal.gov", MAX_UDP_PAYLOAD));
+	BOOST_REQUIRE(append_dictionary_entry(dict, 1, "131.225.0.1", MAX_UDP_PAYLOAD));
+	BOOST_REQUIRE(append_dictionary_entry(dict, 7, "", MAX_UDP_PAYLOAD));
+
+	// Entries that do not fit are refused and leave the announcement intact
+	BOOST_REQUIRE(!append_dictionary_entry(dict, 8, "too long", dict.size() + 4 + 7));
+
+	uint64_t session = 0;
+	uint32_t pid = 0;
+	std::map<uint16_t, std::string> entries;
+	auto collect = [&](uint16_t id, std::string_view str) { entries[id] = std::string(str); };
+	BOOST_REQUIRE(unpack_dictionary(dict.data(), dict.size(), session, pid, collect));
+	BOOST_REQUIRE_EQUAL(session, 0x0123456789abcdefULL);
+	BOOST_REQUIRE_EQUAL(pid, 4242);
+	BOOST_REQUIRE_EQUAL(entries.size(), 3);
+	BOOST_REQUIRE_EQUAL(entries[0], "daq01.fnal.gov");
+	BOOST_REQUIRE_EQUAL(entries[1], "131.225.0.1");
+	BOOST_REQUIRE(entries[7].empty());
+
+	entries.clear();
+	BOOST_REQUIRE(!unpack_dictionary(dict.data(), dict.size() - 1, session, pid, collect));
+	BOOST_REQUIRE_EQUAL(entries.size(), 2);
+
+	std::string body = "dictionary message";
+	DictionaryRecord in;
+	in.severity = 2;
+	in.session = 0x0123456789abcdefULL;
+	in.timestamp_us = 1600000000123456ULL;
+	in.seqNum = 17;
+	in.line = 12;
+	in.hostname = 0;
+	in.hostaddr = 1;
+	in.application = 2;
+	in.category = 3;
+	in.module = 4;
+	in.file = 65535;
+	in.iteration = "Run 1";
+	in.message = body;
+
+	std::string payload;
+	append_dictionary_record(payload, in);
+	BOOST_REQUIRE(is_dictionary_record(payload.data(), payload.size()));
+	BOOST_REQUIRE(!is_dictionary(payload.data(), payload.size()));
+
+	DictionaryRecord out;
+	BOOST_REQUIRE(decode_dictionary_record(payload.data(), payload.size(), out));
+	BOOST_REQUIRE_EQUAL(out.severity, in.severity);
+	BOOST_REQUIRE_EQUAL(out.session, in.session);
+	BOOST_REQUIRE_EQUAL(out.timestamp_us, in.timestamp_us);
+	BOOST_REQUIRE_EQUAL(out.seqNum, in.seqNum);
+	BOOST_REQUIRE_EQUAL(out.line, in.line);
+	BOOST_REQUIRE_EQUAL(out.hostname, in.hostname);
+	BOOST_REQUIRE_EQUAL(out.hostaddr, in.hostaddr);
+	BOOST_REQUIRE_EQUAL(out.application, in.application);
+	BOOST_REQUIRE_EQUAL(out.category, in.category);
+	BOOST_REQUIRE_EQUAL(out.module, in.module);
+	BOOST_REQUIRE_EQUAL(out.file, in.file);
+	BOOST_REQUIRE(out.iteration == in.iteration);
+	BOOST_REQUIRE(out.message == in.message);
+
+	for (size_t len = 0; len < payload.size(); ++len)
+	{
+		BOOST_REQUIRE(!decode_dictionary_record(payload.data(), len, out));
+	}
+
+	payload[DICTIONARY_MAGIC_SIZE + 1] = static_cast<char>(MAX_SEVERITY);
+	BOOST_REQUIRE(decode_dictionary_record(payload.data(), payload.size(), out));
+	BOOST_REQUIRE_EQUAL(out.severity, MAX_SEVERITY);
+	for (int severity : {MAX_SEVERITY + 1, 0xFF})
+	{
+		payload[DICTIONARY_MAGIC_SIZE + 1] = static_cast<char>(severity);
+		BOOST_REQUIRE(!decode_dictionary_record(payload.data(), payload.size(), out));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(FragmentRoundTrip)
+{
+	std::string payload(10000, '\0');
+	for (size_t ii = 0; ii < payload.size(); ++ii) payload[ii] = static_cast<char>('a' + ii % 26);
+
+	const size_t max_size = 1472;
+	std::string scratch;
+	std::vector<std::string> fragments;
+	BOOST_REQUIRE(split_fragments(payload, 77, 5, max_size, scratch, [&](std::string const& frag) { fragments.push_back(frag); }));
+	BOOST_REQUIRE_EQUAL(fragments.size(), (payload.size() + max_size - FRAGMENT_HEADER_SIZE - 1) / (max_size - FRAGMENT_HEADER_SIZE));
+
+	std::string rebuilt(payload.size(), '\0');
+	for (size_t ii = 0; ii < fragments.size(); ++ii)
+	{
+		auto const& frag = fragments[ii];
+		BOOST_REQUIRE_LE(frag.size(), max_size);
+		BOOST_REQUIRE(is_fragment(frag.data(), frag.size()));
+		BOOST_REQUIRE(!is_framed(frag.data(), frag.size()));
+
+		FragmentHeader hdr;
+		std::string_view data;
+		BOOST_REQUIRE(decode_fragment(frag.data(), frag.size(), hdr, data));
+		BOOST_REQUIRE_EQUAL(hdr.index, ii);
+		BOOST_REQUIRE_EQUAL(hdr.count, fragments.size());
+		BOOST_REQUIRE_EQUAL(hdr.session, 77);
+		BOOST_REQUIRE_EQUAL(hdr.message_id, 5);
+		BOOST_REQUIRE_EQUAL(hdr.total_length, payload.size());
+		rebuilt.replace(hdr.offset, data.size(), data);
+	}
+	BOOST_REQUIRE_EQUAL(rebuilt, payload);
+
+	// A fragment claiming data beyond the payload length is rejected
+	auto bad = fragments.back() + "x";
+	FragmentHeader hdr;
+	std::string_view data;
+	BOOST_REQUIRE(!decode_fragment(bad.data(), bad.size(), hdr, data));
+	BOOST_REQUIRE(!decode_fragment(bad.data(), FRAGMENT_HEADER_SIZE - 1, hdr, data));
+
+	// The header must leave room for data
+	BOOST_REQUIRE(!split_fragments(payload, 77, 6, FRAGMENT_HEADER_SIZE, scratch, [](std::string const&) {}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()